@@ -36,7 +36,10 @@ namespace UnrealBuildTool.Rules
 				new string[] {
 					"ExrMedia/Private",
                     "ExrMedia/Private/Assets",
+                    "ExrMedia/Private/Loader",
                     "ExrMedia/Private/Player",
+                    "ExrMedia/Private/Sequence",
+                    "ExrMedia/Private/Stats",
 				}
 			);
 
@@ -10,7 +10,13 @@
  *****************************************************************************/
 
 UExrMediaSource::UExrMediaSource()
-	: FramesPerSecondOverride(0.0f)
+	: DecoderThreads(0)
+	, Exposure(0.0f)
+	, FramesPerSecondOverride(0.0f)
+	, OutputBuffers(0)
+	, OutputFormat(EExrMediaOutputFormat::Hdr)
+	, PrefetchDepth(8)
+	, ProxyResolution(EExrMediaProxyResolution::Full)
 { }
 
 
@@ -46,18 +52,54 @@ void UExrMediaSource::SetSequencePath(const FString& Path)
 
 double UExrMediaSource::GetMediaOption(const FName& Key, const double DefaultValue) const
 {
+	if (Key == ExrMedia::DecoderThreadsOption)
+	{
+		return DecoderThreads;
+	}
+
+	if (Key == ExrMedia::ExposureOption)
+	{
+		return Exposure;
+	}
+
 	if (Key == ExrMedia::FramesPerSecondOverrideOption)
 	{
 		return FramesPerSecondOverride;
 	}
 
+	if (Key == ExrMedia::OutputBuffersOption)
+	{
+		return OutputBuffers;
+	}
+
+	if (Key == ExrMedia::OutputFormatOption)
+	{
+		return (double)OutputFormat;
+	}
+
+	if (Key == ExrMedia::PrefetchDepthOption)
+	{
+		return PrefetchDepth;
+	}
+
+	if (Key == ExrMedia::ProxyLevelOption)
+	{
+		return (double)ProxyResolution;
+	}
+
 	return Super::GetMediaOption(Key, DefaultValue);
 }
 
 
 bool UExrMediaSource::HasMediaOption(const FName& Key) const
 {
-	if (Key == ExrMedia::FramesPerSecondOverrideOption)
+	if ((Key == ExrMedia::DecoderThreadsOption) ||
+		(Key == ExrMedia::ExposureOption) ||
+		(Key == ExrMedia::FramesPerSecondOverrideOption) ||
+		(Key == ExrMedia::OutputBuffersOption) ||
+		(Key == ExrMedia::OutputFormatOption) ||
+		(Key == ExrMedia::PrefetchDepthOption) ||
+		(Key == ExrMedia::ProxyLevelOption))
 	{
 		return true;
 	}
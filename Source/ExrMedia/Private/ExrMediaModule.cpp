@@ -2,9 +2,14 @@
 
 #include "ExrMediaPrivate.h"
 
+#include "ExrMediaDecodeScheduler.h"
 #include "ExrMediaPlayer.h"
+#include "ExrMediaSequenceIndex.h"
+#include "HAL/PlatformMisc.h"
 #include "IExrMediaModule.h"
 #include "Modules/ModuleManager.h"
+#include "OpenExrWrapper.h"
+#include "UObject/Class.h"
 
 
 DEFINE_LOG_CATEGORY(LogExrMedia);
@@ -13,7 +18,7 @@ DEFINE_LOG_CATEGORY(LogExrMedia);
 
 
 /**
- * Implements the AVFMedia module.
+ * Implements the ExrMedia module.
  */
 class FExrMediaModule
 	: public IExrMediaModule
@@ -21,7 +26,9 @@ class FExrMediaModule
 public:
 
 	/** Default constructor. */
-	FExrMediaModule() { }
+	FExrMediaModule()
+		: OpenExrInitialized(false)
+	{ }
 
 public:
 
@@ -29,7 +36,23 @@ public:
 
 	virtual TSharedPtr<IMediaPlayer> CreatePlayer() override
 	{
-		return MakeShareable(new FExrMediaPlayer());
+		InitializeOpenExr();
+		InitializeDecodeScheduler();
+
+		return MakeShareable(new FExrMediaPlayer(DecodeScheduler.ToSharedRef()));
+	}
+
+	virtual bool PackSequence(const FString& SequencePath, const FString& ContainerPath) override
+	{
+		FExrMediaSequenceIndex SequenceIndex;
+
+		if (!SequenceIndex.Build(SequencePath))
+		{
+			UE_LOG(LogExrMedia, Error, TEXT("The directory %s does not contain any .exr image files"), *SequencePath);
+			return false;
+		}
+
+		return SequenceIndex.SaveContainer(ContainerPath);
 	}
 
 public:
@@ -37,7 +60,76 @@ public:
 	//~ IModuleInterface interface
 
 	virtual void StartupModule() override { }
-	virtual void ShutdownModule() override { }
+
+	virtual void ShutdownModule() override
+	{
+		// players that are still alive keep the scheduler alive
+		DecodeScheduler.Reset();
+	}
+
+protected:
+
+	/**
+	 * Create the decode scheduler that all players share.
+	 *
+	 * Like OpenEXR's thread pool, the scheduler is created when the first
+	 * player is created, because it is configured by the settings object.
+	 */
+	void InitializeDecodeScheduler()
+	{
+		if (DecodeScheduler.IsValid())
+		{
+			return;
+		}
+
+		int32 DecoderThreads = GetDefault<UExrMediaSettings>()->DecoderThreads;
+
+		if (DecoderThreads <= 0)
+		{
+			DecoderThreads = FMath::Max(1, FPlatformMisc::NumberOfCoresIncludingHyperthreads() - 1);
+		}
+
+		const SIZE_T MemoryBudget = (SIZE_T)FMath::Max(1, GetDefault<UExrMediaSettings>()->CacheSizeMB) * 1024 * 1024;
+
+		DecodeScheduler = MakeShareable(new FExrMediaDecodeScheduler(DecoderThreads, MemoryBudget));
+	}
+
+	/**
+	 * Initialize OpenEXR's global thread pool.
+	 *
+	 * The settings object is not available yet when this module starts up,
+	 * so initialization is deferred until the first player is created.
+	 */
+	void InitializeOpenExr()
+	{
+		if (OpenExrInitialized)
+		{
+			return;
+		}
+
+		int32 IntraFrameThreads = GetDefault<UExrMediaSettings>()->IntraFrameThreads;
+
+		// OpenEXR's thread pool is global to the process, but the loaders only use it for
+		// the frame at the play head; frames decoded ahead of time never use the pool, so
+		// it does not compete with the decoder threads while the sequence is playing
+		if (IntraFrameThreads <= 0)
+		{
+			IntraFrameThreads = FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+		}
+
+		FRgbaInputFile::SetGlobalThreadCount(IntraFrameThreads);
+		OpenExrInitialized = true;
+
+		UE_LOG(LogExrMedia, Verbose, TEXT("Initialized OpenEXR with %i threads"), IntraFrameThreads);
+	}
+
+private:
+
+	/** The decode scheduler that all players share (created with the first player). */
+	TSharedPtr<FExrMediaDecodeScheduler, ESPMode::ThreadSafe> DecodeScheduler;
+
+	/** Whether OpenEXR's global thread pool has been initialized. */
+	bool OpenExrInitialized;
 };
 
 
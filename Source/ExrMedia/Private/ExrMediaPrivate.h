@@ -14,9 +14,27 @@ DECLARE_LOG_CATEGORY_EXTERN(LogExrMedia, Log, All);
 
 namespace ExrMedia
 {
+	/** Name of the DecoderThreads media option. */
+	static FName DecoderThreadsOption("DecoderThreads");
+
+	/** Name of the Exposure media option. */
+	static FName ExposureOption("Exposure");
+
 	/** Name of the FramesPerSecondAttribute media option. */
 	static FName FramesPerSecondAttributeOption("FramesPerSecondAttribute");
 
 	/** Name of the FramesPerSecondOverride media option. */
 	static FName FramesPerSecondOverrideOption("FramesPerSecondOverride");
+
+	/** Name of the OutputBuffers media option. */
+	static FName OutputBuffersOption("OutputBuffers");
+
+	/** Name of the OutputFormat media option. */
+	static FName OutputFormatOption("OutputFormat");
+
+	/** Name of the PrefetchDepth media option. */
+	static FName PrefetchDepthOption("PrefetchDepth");
+
+	/** Name of the ProxyLevel media option. */
+	static FName ProxyLevelOption("ProxyLevel");
 }
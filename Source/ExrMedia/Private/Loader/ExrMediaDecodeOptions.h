@@ -0,0 +1,60 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "Containers/UnrealString.h"
+#include "IMediaTextureSink.h"
+
+
+/**
+ * Options that control how EXR image sequence frames are decoded.
+ */
+struct FExrMediaDecodeOptions
+{
+	/**
+	 * Names of the channels that full resolution frames are decoded into, in pixel order.
+	 *
+	 * Set for single channel and RGB sequences, whose frames are decoded without
+	 * filling in constant channels, and for layers other than the default layer
+	 * (empty = decode RGBA pixels of the default layer).
+	 */
+	TArray<FString> ChannelNames;
+
+	/** Whether channels are decoded straight into the frame buffer, bypassing OpenEXR's RGBA conversion layer. */
+	bool DirectChannels;
+
+	/** Linear factor that color channels are multiplied with when converting to 8-bit output. */
+	float ExposureScale;
+
+	/** Whether image files are read through memory mappings instead of file reads. */
+	bool MemoryMapped;
+
+	/** The mip level to decode from tiled images (0 = full resolution). */
+	int32 MipLevel;
+
+	/** Number of horizontal stripes that frames needed immediately are decoded in parallel (1 = not striped). */
+	int32 NumStripes;
+
+	/** The pixel format of decoded frames (FloatRGBA, FloatRGB or CharBGRA). */
+	EMediaTextureSinkFormat OutputFormat;
+
+	/** Index of the image part to decode (0 = first part). */
+	int32 Part;
+
+	/** Factor by which scan line images are reduced in width and height (1 = full resolution). */
+	int32 SubsampleFactor;
+
+	/** Default constructor. */
+	FExrMediaDecodeOptions()
+		: DirectChannels(false)
+		, ExposureScale(1.0f)
+		, MemoryMapped(false)
+		, MipLevel(0)
+		, NumStripes(1)
+		, OutputFormat(EMediaTextureSinkFormat::FloatRGBA)
+		, Part(0)
+		, SubsampleFactor(1)
+	{ }
+};
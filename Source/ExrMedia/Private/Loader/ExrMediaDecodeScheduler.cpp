@@ -0,0 +1,282 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "ExrMediaDecodeScheduler.h"
+#include "ExrMediaPrivate.h"
+
+#include "HAL/PlatformProcess.h"
+#include "Misc/IQueuedWork.h"
+#include "Misc/QueuedThreadPool.h"
+#include "Misc/ScopeLock.h"
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/**
+ * Runs a loader's work item on a decoder thread and notifies the scheduler when it is done.
+ *
+ * Work items delete themselves when they are done or abandoned.
+ */
+class FExrMediaScheduledWork
+	: public IQueuedWork
+{
+public:
+
+	/** Create and initialize a new instance. */
+	FExrMediaScheduledWork(FExrMediaDecodeScheduler& InScheduler, const FExrMediaLoader& InLoader, IQueuedWork* InWork)
+		: Loader(InLoader)
+		, Scheduler(InScheduler)
+		, Work(InWork)
+	{ }
+
+public:
+
+	//~ IQueuedWork interface
+
+	virtual void Abandon() override
+	{
+		Work->Abandon();
+		Scheduler.NotifyWorkDone(Loader);
+
+		delete this;
+	}
+
+	virtual void DoThreadedWork() override
+	{
+		Work->DoThreadedWork();
+		Scheduler.NotifyWorkDone(Loader);
+
+		delete this;
+	}
+
+private:
+
+	/** The loader that the work belongs to. */
+	const FExrMediaLoader& Loader;
+
+	/** The scheduler that started the work. */
+	FExrMediaDecodeScheduler& Scheduler;
+
+	/** The loader's work item (deletes itself when done). */
+	IQueuedWork* Work;
+};
+
+
+/* FExrMediaDecodeScheduler structors
+ *****************************************************************************/
+
+FExrMediaDecodeScheduler::FExrMediaDecodeScheduler(int32 InNumWorkers, SIZE_T InMemoryBudget)
+	: MemoryBudget(InMemoryBudget)
+	, NumRunning(0)
+	, NumWorkers(FMath::Max(1, InNumWorkers))
+{
+	// one extra thread is reserved for the frames at the play heads
+	ThreadPool = FQueuedThreadPool::Allocate();
+	verify(ThreadPool->Create(NumWorkers + 1, 256 * 1024, TPri_Normal));
+
+	UE_LOG(LogExrMedia, Verbose, TEXT("Created decode scheduler with %i workers and %.1f MB frame memory"), NumWorkers, MemoryBudget / (1024.0 * 1024.0));
+}
+
+
+FExrMediaDecodeScheduler::~FExrMediaDecodeScheduler()
+{
+	check(Loaders.Num() == 0);
+
+	for (const FQueuedWork& Queued : QueuedWork)
+	{
+		Queued.Work->Abandon();
+	}
+
+	QueuedWork.Empty();
+
+	ThreadPool->Destroy();
+	delete ThreadPool;
+	ThreadPool = nullptr;
+}
+
+
+/* FExrMediaDecodeScheduler interface
+ *****************************************************************************/
+
+void FExrMediaDecodeScheduler::AddWork(const FExrMediaLoader& Loader, IQueuedWork* Work, double Deadline, bool Urgent)
+{
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		const FLoaderState* State = Loaders.Find(&Loader);
+
+		if ((State != nullptr) && !State->Unregistering)
+		{
+			FQueuedWork& Queued = QueuedWork[QueuedWork.AddUninitialized()];
+			{
+				Queued.Deadline = Deadline;
+				Queued.Loader = &Loader;
+				Queued.Urgent = Urgent;
+				Queued.Work = Work;
+			}
+
+			DispatchWork();
+
+			return;
+		}
+	}
+
+	Work->Abandon();
+}
+
+
+SIZE_T FExrMediaDecodeScheduler::GetCacheBudget() const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	return MemoryBudget / FMath::Max(1, Loaders.Num());
+}
+
+
+void FExrMediaDecodeScheduler::GetStats(int32& OutNumLoaders, int32& OutNumQueued, int32& OutNumRunning) const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	OutNumLoaders = Loaders.Num();
+	OutNumQueued = QueuedWork.Num();
+	OutNumRunning = NumRunning;
+}
+
+
+int32 FExrMediaDecodeScheduler::GetWorkerShare() const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	return FMath::DivideAndRoundUp(NumWorkers, FMath::Max(1, Loaders.Num()));
+}
+
+
+void FExrMediaDecodeScheduler::NotifyWorkDone(const FExrMediaLoader& Loader)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	--NumRunning;
+
+	FLoaderState* State = Loaders.Find(&Loader);
+
+	if (State != nullptr)
+	{
+		--State->NumRunning;
+	}
+
+	DispatchWork();
+}
+
+
+void FExrMediaDecodeScheduler::Register(const FExrMediaLoader& Loader)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	Loaders.Add(&Loader);
+}
+
+
+void FExrMediaDecodeScheduler::Unregister(const FExrMediaLoader& Loader)
+{
+	TArray<IQueuedWork*> AbandonedWork;
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		FLoaderState* State = Loaders.Find(&Loader);
+
+		if (State == nullptr)
+		{
+			return;
+		}
+
+		State->Unregistering = true;
+
+		for (int32 Index = QueuedWork.Num() - 1; Index >= 0; --Index)
+		{
+			if (QueuedWork[Index].Loader == &Loader)
+			{
+				AbandonedWork.Add(QueuedWork[Index].Work);
+				QueuedWork.RemoveAtSwap(Index);
+			}
+		}
+	}
+
+	for (IQueuedWork* Work : AbandonedWork)
+	{
+		Work->Abandon();
+	}
+
+	// running work calls back into the loader when it completes
+	while (true)
+	{
+		{
+			FScopeLock Lock(&CriticalSection);
+
+			if (Loaders.FindChecked(&Loader).NumRunning == 0)
+			{
+				Loaders.Remove(&Loader);
+
+				return;
+			}
+		}
+
+		FPlatformProcess::Sleep(0.001f);
+	}
+}
+
+
+/* FExrMediaDecodeScheduler implementation
+ *****************************************************************************/
+
+void FExrMediaDecodeScheduler::DispatchWork()
+{
+	// workers beyond NumWorkers only take urgent work
+	while (NumRunning <= NumWorkers)
+	{
+		const int32 Index = FindNextWork(NumRunning == NumWorkers);
+
+		if (Index == INDEX_NONE)
+		{
+			return;
+		}
+
+		const FQueuedWork Queued = QueuedWork[Index];
+		QueuedWork.RemoveAtSwap(Index);
+
+		++NumRunning;
+		++Loaders.FindChecked(Queued.Loader).NumRunning;
+
+		ThreadPool->AddQueuedWork(new FExrMediaScheduledWork(*this, *Queued.Loader, Queued.Work));
+	}
+}
+
+
+int32 FExrMediaDecodeScheduler::FindNextWork(bool UrgentOnly) const
+{
+	// loaders that run fewer than their share of the workers go first,
+	// and within either group the work with the earliest deadline wins
+	const int32 FairShare = FMath::DivideAndRoundUp(NumWorkers, FMath::Max(1, Loaders.Num()));
+
+	int32 BestIndex = INDEX_NONE;
+	bool BestIsFair = false;
+
+	for (int32 Index = 0; Index < QueuedWork.Num(); ++Index)
+	{
+		const FQueuedWork& Queued = QueuedWork[Index];
+
+		if (UrgentOnly && !Queued.Urgent)
+		{
+			continue;
+		}
+
+		const bool IsFair = (Loaders.FindChecked(Queued.Loader).NumRunning < FairShare);
+
+		if ((BestIndex == INDEX_NONE) || (IsFair && !BestIsFair) || ((IsFair == BestIsFair) && (Queued.Deadline < QueuedWork[BestIndex].Deadline)))
+		{
+			BestIndex = Index;
+			BestIsFair = IsFair;
+		}
+	}
+
+	return BestIndex;
+}
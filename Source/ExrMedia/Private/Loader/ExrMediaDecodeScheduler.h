@@ -0,0 +1,195 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "Containers/Map.h"
+#include "HAL/CriticalSection.h"
+
+class FExrMediaLoader;
+class FQueuedThreadPool;
+class IQueuedWork;
+
+
+/**
+ * Schedules decoder work of all image sequence loaders in the process on one pool of decoder threads.
+ *
+ * Loaders hand their work items to the scheduler along with the time at which
+ * the frame is due for display. The scheduler keeps at most NumWorkers items
+ * running at a time and always starts the item with the earliest deadline next,
+ * preferring loaders that run fewer than their fair share of the workers, so
+ * that a loader with a deep prefetch window cannot starve the others. One extra
+ * thread is reserved for urgent work, i.e. the frames at the play heads.
+ *
+ * The memory budget for decoded frames is split evenly among the registered
+ * loaders, and each loader sizes its frame cache to its share.
+ */
+class FExrMediaDecodeScheduler
+{
+public:
+
+	/**
+	 * Create and initialize a new instance.
+	 *
+	 * @param InNumWorkers Number of frames to decode in parallel across all loaders.
+	 * @param InMemoryBudget Maximum number of bytes of decoded frames to cache across all loaders.
+	 */
+	FExrMediaDecodeScheduler(int32 InNumWorkers, SIZE_T InMemoryBudget);
+
+	/** Destructor. */
+	~FExrMediaDecodeScheduler();
+
+public:
+
+	/**
+	 * Queue a work item of the specified loader.
+	 *
+	 * Work items of loaders that are not registered are abandoned right away.
+	 *
+	 * @param Loader The loader that the work belongs to.
+	 * @param Work The work item to queue (will be deleted by the work item itself).
+	 * @param Deadline The time at which the work's frame is due (in seconds, see FPlatformTime::Seconds).
+	 * @param Urgent Whether the work may run on the reserved thread.
+	 */
+	void AddWork(const FExrMediaLoader& Loader, IQueuedWork* Work, double Deadline, bool Urgent);
+
+	/**
+	 * Get the share of the memory budget that each loader may use for its frame cache.
+	 *
+	 * @return Cache budget (in bytes).
+	 */
+	SIZE_T GetCacheBudget() const;
+
+	/**
+	 * Get the number of frames that are decoded in parallel across all loaders.
+	 *
+	 * @return Number of decoder workers.
+	 */
+	int32 GetNumWorkers() const
+	{
+		return NumWorkers;
+	}
+
+	/**
+	 * Get the scheduler's statistics.
+	 *
+	 * @param OutNumLoaders Will contain the number of registered loaders.
+	 * @param OutNumQueued Will contain the number of work items that are waiting for a worker.
+	 * @param OutNumRunning Will contain the number of work items that are being decoded.
+	 */
+	void GetStats(int32& OutNumLoaders, int32& OutNumQueued, int32& OutNumRunning) const;
+
+	/**
+	 * Get the number of workers that each loader can expect to decode its frames on.
+	 *
+	 * The workers are shared by all registered loaders, so a loader's decoding
+	 * throughput is bounded by its fair share rather than by the total.
+	 *
+	 * @return Number of decoder workers per loader.
+	 * @see GetNumWorkers
+	 */
+	int32 GetWorkerShare() const;
+
+	/**
+	 * Notify the scheduler that a work item has finished or was abandoned.
+	 *
+	 * This method is called on a decoder thread.
+	 *
+	 * @param Loader The loader that the work belonged to.
+	 */
+	void NotifyWorkDone(const FExrMediaLoader& Loader);
+
+	/**
+	 * Register a loader with the scheduler.
+	 *
+	 * @param Loader The loader to register.
+	 * @see Unregister
+	 */
+	void Register(const FExrMediaLoader& Loader);
+
+	/**
+	 * Unregister a loader from the scheduler.
+	 *
+	 * The loader's queued work is abandoned, and this method blocks
+	 * until the loader's running work has finished.
+	 *
+	 * @param Loader The loader to unregister.
+	 * @see Register
+	 */
+	void Unregister(const FExrMediaLoader& Loader);
+
+protected:
+
+	/**
+	 * Start queued work items while workers are available.
+	 *
+	 * The caller must hold the critical section.
+	 */
+	void DispatchWork();
+
+	/**
+	 * Find the queued work item to start next.
+	 *
+	 * The caller must hold the critical section.
+	 *
+	 * @param UrgentOnly Whether to consider urgent work items only.
+	 * @return Index of the work item, or INDEX_NONE if there is none.
+	 */
+	int32 FindNextWork(bool UrgentOnly) const;
+
+private:
+
+	/** A loader that is registered with the scheduler. */
+	struct FLoaderState
+	{
+		/** Number of the loader's work items that are being decoded. */
+		int32 NumRunning;
+
+		/** Whether the loader is being unregistered. */
+		bool Unregistering;
+
+		/** Create and initialize a new instance. */
+		FLoaderState()
+			: NumRunning(0)
+			, Unregistering(false)
+		{ }
+	};
+
+	/** A work item that is waiting for a worker. */
+	struct FQueuedWork
+	{
+		/** The time at which the work's frame is due (in seconds). */
+		double Deadline;
+
+		/** The loader that the work belongs to. */
+		const FExrMediaLoader* Loader;
+
+		/** Whether the work may run on the reserved thread. */
+		bool Urgent;
+
+		/** The work item. */
+		IQueuedWork* Work;
+	};
+
+	/** Critical section for synchronizing access to the queue and the loader states. */
+	mutable FCriticalSection CriticalSection;
+
+	/** States of the registered loaders. */
+	TMap<const FExrMediaLoader*, FLoaderState> Loaders;
+
+	/** Maximum number of bytes of decoded frames to cache across all loaders. */
+	SIZE_T MemoryBudget;
+
+	/** Number of work items that are being decoded. */
+	int32 NumRunning;
+
+	/** Number of frames to decode in parallel across all loaders. */
+	int32 NumWorkers;
+
+	/** Work items that are waiting for a worker. */
+	TArray<FQueuedWork> QueuedWork;
+
+	/** The pool of decoder threads. */
+	FQueuedThreadPool* ThreadPool;
+};
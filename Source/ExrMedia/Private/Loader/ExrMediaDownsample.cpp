@@ -0,0 +1,68 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "ExrMediaDownsample.h"
+#include "ExrMediaPrivate.h"
+
+#include "ExrMediaSimd.h"
+#include "Math/Float16.h"
+#include "Math/UnrealMathUtility.h"
+
+
+/* ExrMedia functions
+ *****************************************************************************/
+
+void ExrMedia::DownsampleRow(const uint16* Source, int32 SourceWidth, int32 NumRows, int32 Factor, uint16* Dest)
+{
+	const int32 DestWidth = FMath::DivideAndRoundUp(SourceWidth, Factor);
+
+	for (int32 DestX = 0; DestX < DestWidth; ++DestX)
+	{
+		const int32 StartX = DestX * Factor;
+		const int32 NumColumns = FMath::Min(Factor, SourceWidth - StartX);
+		const float Scale = 1.0f / (NumColumns * NumRows);
+
+#if EXRMEDIA_SSE2
+		// each pixel's four channels are filtered in one vector
+		const __m128i Zero = _mm_setzero_si128();
+		__m128 Sum = _mm_setzero_ps();
+
+		for (int32 Row = 0; Row < NumRows; ++Row)
+		{
+			const uint16* Pixel = Source + (Row * SourceWidth + StartX) * 4;
+
+			for (int32 Column = 0; Column < NumColumns; ++Column, Pixel += 4)
+			{
+				const __m128i Half = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)Pixel), Zero);
+				Sum = _mm_add_ps(Sum, ExrMediaHalfToFloat(Half));
+			}
+		}
+
+		// sign extend, so that the signed saturation of the pack leaves all bits intact
+		__m128i Result = ExrMediaFloatToHalf(_mm_mul_ps(Sum, _mm_set1_ps(Scale)));
+		Result = _mm_srai_epi32(_mm_slli_epi32(Result, 16), 16);
+		_mm_storel_epi64((__m128i*)(Dest + DestX * 4), _mm_packs_epi32(Result, Result));
+#else
+		float Sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+		for (int32 Row = 0; Row < NumRows; ++Row)
+		{
+			const FFloat16* Pixel = (const FFloat16*)(Source + (Row * SourceWidth + StartX) * 4);
+
+			for (int32 Column = 0; Column < NumColumns; ++Column, Pixel += 4)
+			{
+				Sum[0] += Pixel[0];
+				Sum[1] += Pixel[1];
+				Sum[2] += Pixel[2];
+				Sum[3] += Pixel[3];
+			}
+		}
+
+		FFloat16* DestPixel = (FFloat16*)(Dest + DestX * 4);
+
+		DestPixel[0] = Sum[0] * Scale;
+		DestPixel[1] = Sum[1] * Scale;
+		DestPixel[2] = Sum[2] * Scale;
+		DestPixel[3] = Sum[3] * Scale;
+#endif
+	}
+}
@@ -0,0 +1,24 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+
+
+namespace ExrMedia
+{
+	/**
+	 * Box filter rows of half-float RGBA pixels into a single row of reduced width.
+	 *
+	 * Each destination pixel is the average of a block of Factor source pixels in
+	 * each of the given rows. Blocks at the right edge may be narrower than Factor.
+	 * Uses SSE2 where available and falls back to scalar code elsewhere.
+	 *
+	 * @param Source The source rows (NumRows consecutive rows of SourceWidth pixels).
+	 * @param SourceWidth Width of the source rows (in pixels).
+	 * @param NumRows Number of source rows to filter (1 to Factor).
+	 * @param Factor Horizontal reduction factor.
+	 * @param Dest Will contain the filtered row (SourceWidth / Factor pixels, rounded up).
+	 */
+	void DownsampleRow(const uint16* Source, int32 SourceWidth, int32 NumRows, int32 Factor, uint16* Dest);
+}
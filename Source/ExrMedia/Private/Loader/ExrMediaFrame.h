@@ -0,0 +1,62 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "ExrMediaStats.h"
+#include "IMediaTextureSink.h"
+#include "Math/IntPoint.h"
+
+
+/**
+ * Holds a decoded EXR image sequence frame.
+ */
+struct FExrMediaFrame
+{
+	/** The frame's pixel data. */
+	TArray<uint8> Data;
+
+	/** Width and height of the frame (in pixels). */
+	FIntPoint Dim;
+
+	/** The format of the pixel data (16-bit floating point RGBA, packed 32-bit floating point RGB, or 8-bit sRGB BGRA). */
+	EMediaTextureSinkFormat Format;
+
+	/** Index of the frame within its image sequence. */
+	int32 FrameIndex;
+
+	/** Number of bytes per row of pixel data. */
+	uint32 Stride;
+
+	/** Default constructor. */
+	FExrMediaFrame()
+		: Dim(FIntPoint::ZeroValue)
+		, Format(EMediaTextureSinkFormat::FloatRGBA)
+		, FrameIndex(INDEX_NONE)
+		, Stride(0)
+		, TrackedSize(0)
+	{ }
+
+	/** Destructor. */
+	~FExrMediaFrame()
+	{
+		DEC_MEMORY_STAT_BY(STAT_ExrMedia_FrameMemory, TrackedSize);
+	}
+
+	/** Update the frame memory stat after the pixel data was (re)allocated. */
+	void TrackMemory()
+	{
+		const SIZE_T Size = Data.GetAllocatedSize();
+
+		INC_MEMORY_STAT_BY(STAT_ExrMedia_FrameMemory, Size);
+		DEC_MEMORY_STAT_BY(STAT_ExrMedia_FrameMemory, TrackedSize);
+
+		TrackedSize = Size;
+	}
+
+private:
+
+	/** Size of the pixel data that is accounted for in the frame memory stat (in bytes). */
+	SIZE_T TrackedSize;
+};
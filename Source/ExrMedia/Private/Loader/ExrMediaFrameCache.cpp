@@ -0,0 +1,116 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "ExrMediaFrameCache.h"
+
+
+/* FExrMediaFrameCache structors
+ *****************************************************************************/
+
+FExrMediaFrameCache::FExrMediaFrameCache(SIZE_T InBudget)
+	: Budget(InBudget)
+	, NumEvictions(0)
+	, NumHits(0)
+	, NumMisses(0)
+	, Size(0)
+{ }
+
+
+/* FExrMediaFrameCache interface
+ *****************************************************************************/
+
+void FExrMediaFrameCache::Add(const FExrMediaFrameCacheKey& Key, const TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe>& Frame)
+{
+	check(Frame.IsValid());
+
+	const SIZE_T FrameSize = Frame->Data.Num();
+
+	// replace existing entry
+	FEntry* Entry = Entries.Find(Key);
+
+	if (Entry != nullptr)
+	{
+		Size -= Entry->Frame->Data.Num();
+		UsageList.RemoveNode(Entry->Node);
+		Entries.Remove(Key);
+	}
+
+	Trim((FrameSize < Budget) ? (Budget - FrameSize) : 0);
+
+	UsageList.AddHead(Key);
+
+	FEntry& NewEntry = Entries.Add(Key);
+	{
+		NewEntry.Frame = Frame;
+		NewEntry.Node = UsageList.GetHead();
+	}
+
+	Size += FrameSize;
+}
+
+
+void FExrMediaFrameCache::Empty()
+{
+	Entries.Empty();
+	UsageList.Empty();
+	Size = 0;
+}
+
+
+TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> FExrMediaFrameCache::Find(const FExrMediaFrameCacheKey& Key)
+{
+	FEntry* Entry = Entries.Find(Key);
+
+	if (Entry == nullptr)
+	{
+		++NumMisses;
+
+		return nullptr;
+	}
+
+	++NumHits;
+
+	// move to front of usage list
+	if (Entry->Node != UsageList.GetHead())
+	{
+		UsageList.RemoveNode(Entry->Node);
+		UsageList.AddHead(Key);
+		Entry->Node = UsageList.GetHead();
+	}
+
+	return Entry->Frame;
+}
+
+
+TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> FExrMediaFrameCache::Peek(const FExrMediaFrameCacheKey& Key) const
+{
+	const FEntry* Entry = Entries.Find(Key);
+
+	return (Entry != nullptr) ? Entry->Frame : nullptr;
+}
+
+
+void FExrMediaFrameCache::SetBudget(SIZE_T InBudget)
+{
+	Budget = InBudget;
+
+	Trim(Budget);
+}
+
+
+/* FExrMediaFrameCache implementation
+ *****************************************************************************/
+
+void FExrMediaFrameCache::Trim(SIZE_T MaxSize)
+{
+	while ((Size > MaxSize) && (UsageList.GetTail() != nullptr))
+	{
+		TDoubleLinkedList<FExrMediaFrameCacheKey>::TDoubleLinkedListNode* Tail = UsageList.GetTail();
+		const FExrMediaFrameCacheKey Key = Tail->GetValue();
+
+		Size -= Entries.FindChecked(Key).Frame->Data.Num();
+		Entries.Remove(Key);
+		UsageList.RemoveNode(Tail);
+
+		++NumEvictions;
+	}
+}
@@ -0,0 +1,192 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/List.h"
+#include "Containers/Map.h"
+#include "Containers/UnrealString.h"
+#include "Templates/SharedPointer.h"
+
+#include "ExrMediaFrame.h"
+
+
+/**
+ * Identifies a frame in the frame cache.
+ */
+struct FExrMediaFrameCacheKey
+{
+	/** Identifies the image sequence that the frame belongs to. */
+	FString Sequence;
+
+	/** Index of the frame within its image sequence. */
+	int32 FrameIndex;
+
+	/** Create and initialize a new instance. */
+	FExrMediaFrameCacheKey(const FString& InSequence, int32 InFrameIndex)
+		: Sequence(InSequence)
+		, FrameIndex(InFrameIndex)
+	{ }
+
+	/** Compare two cache keys for equality. */
+	friend bool operator==(const FExrMediaFrameCacheKey& A, const FExrMediaFrameCacheKey& B)
+	{
+		return (A.FrameIndex == B.FrameIndex) && (A.Sequence == B.Sequence);
+	}
+
+	/** Get the hash code for the specified cache key. */
+	friend uint32 GetTypeHash(const FExrMediaFrameCacheKey& Key)
+	{
+		return HashCombine(GetTypeHash(Key.Sequence), GetTypeHash(Key.FrameIndex));
+	}
+};
+
+
+/**
+ * Caches decoded image sequence frames up to a memory budget.
+ *
+ * When the budget is exceeded, the least recently used frames are evicted.
+ * This class is not thread-safe; the owner is expected to synchronize access.
+ */
+class FExrMediaFrameCache
+{
+public:
+
+	/**
+	 * Create and initialize a new instance.
+	 *
+	 * @param InBudget Maximum number of bytes of frame data to keep in the cache.
+	 */
+	FExrMediaFrameCache(SIZE_T InBudget);
+
+public:
+
+	/**
+	 * Add a frame to the cache and make it the most recently used one.
+	 *
+	 * Least recently used frames are evicted until the cache fits its budget.
+	 * A frame that is larger than the entire budget evicts all other frames,
+	 * so that the most recently decoded frame is always available.
+	 *
+	 * @param Key The frame's cache key.
+	 * @param Frame The frame to add.
+	 */
+	void Add(const FExrMediaFrameCacheKey& Key, const TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe>& Frame);
+
+	/**
+	 * Check whether the cache contains the specified frame.
+	 *
+	 * This method neither updates the usage order nor the hit and miss counters.
+	 *
+	 * @param Key The frame's cache key.
+	 * @return true if the frame is cached, false otherwise.
+	 */
+	bool Contains(const FExrMediaFrameCacheKey& Key) const
+	{
+		return Entries.Contains(Key);
+	}
+
+	/** Remove all frames from the cache. */
+	void Empty();
+
+	/**
+	 * Find the specified frame, make it the most recently used one and update the hit and miss counters.
+	 *
+	 * @param Key The frame's cache key.
+	 * @return The frame, or nullptr if it is not cached.
+	 * @see Peek
+	 */
+	TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> Find(const FExrMediaFrameCacheKey& Key);
+
+	/** Get the maximum number of bytes of frame data that the cache may hold. */
+	SIZE_T GetBudget() const
+	{
+		return Budget;
+	}
+
+	/** Get the number of frames that were evicted to stay within the budget. */
+	uint64 GetNumEvictions() const
+	{
+		return NumEvictions;
+	}
+
+	/** Get the number of frames currently in the cache. */
+	int32 GetNumFrames() const
+	{
+		return Entries.Num();
+	}
+
+	/** Get the number of lookups that found their frame. */
+	uint64 GetNumHits() const
+	{
+		return NumHits;
+	}
+
+	/** Get the number of lookups that did not find their frame. */
+	uint64 GetNumMisses() const
+	{
+		return NumMisses;
+	}
+
+	/** Get the number of bytes of frame data currently in the cache. */
+	SIZE_T GetSize() const
+	{
+		return Size;
+	}
+
+	/**
+	 * Find the specified frame without updating the usage order or the hit and miss counters.
+	 *
+	 * @param Key The frame's cache key.
+	 * @return The frame, or nullptr if it is not cached.
+	 * @see Find
+	 */
+	TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> Peek(const FExrMediaFrameCacheKey& Key) const;
+
+	/**
+	 * Change the maximum number of bytes of frame data that the cache may hold.
+	 *
+	 * Least recently used frames are evicted until the cache fits the new budget.
+	 *
+	 * @param InBudget The new budget (in bytes).
+	 */
+	void SetBudget(SIZE_T InBudget);
+
+protected:
+
+	/** Evict least recently used frames until the cache fits the specified number of bytes. */
+	void Trim(SIZE_T MaxSize);
+
+private:
+
+	/** A cached frame. */
+	struct FEntry
+	{
+		/** The cached frame. */
+		TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> Frame;
+
+		/** The entry's node in the usage list. */
+		TDoubleLinkedList<FExrMediaFrameCacheKey>::TDoubleLinkedListNode* Node;
+	};
+
+	/** Maximum number of bytes of frame data to keep in the cache. */
+	SIZE_T Budget;
+
+	/** Cached frames. */
+	TMap<FExrMediaFrameCacheKey, FEntry> Entries;
+
+	/** Number of frames that were evicted to stay within the budget. */
+	uint64 NumEvictions;
+
+	/** Number of lookups that found their frame. */
+	uint64 NumHits;
+
+	/** Number of lookups that did not find their frame. */
+	uint64 NumMisses;
+
+	/** Number of bytes of frame data currently in the cache. */
+	SIZE_T Size;
+
+	/** Cache keys ordered from most recently to least recently used. */
+	TDoubleLinkedList<FExrMediaFrameCacheKey> UsageList;
+};
@@ -0,0 +1,396 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "ExrMediaLoader.h"
+#include "ExrMediaPrivate.h"
+
+#include "ExrMediaDecodeScheduler.h"
+#include "ExrMediaLoaderWork.h"
+#include "ExrMediaSequenceIndex.h"
+#include "ExrMediaStats.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/ScopeLock.h"
+#include "OpenExrWrapper.h"
+
+
+/* FExrMediaLoader structors
+ *****************************************************************************/
+
+FExrMediaLoader::FExrMediaLoader(const TSharedRef<FExrMediaSequenceIndex, ESPMode::ThreadSafe>& InSequenceIndex, const TSharedRef<FExrMediaDecodeScheduler, ESPMode::ThreadSafe>& InScheduler, int32 InPrefetchDepth, int32 InNumWorkers, const FExrMediaDecodeOptions& InDecodeOptions, FExrMediaPlaybackStats& InStats)
+	: AverageDecodeTime(0.0)
+	, Cache(0)
+	, DecodeOptions(InDecodeOptions)
+	, Direction(1)
+	, FrameInterval(1.0 / 24.0)
+	, FrameStep(1)
+	, Generation(0)
+	, LastFrameSize(0)
+	, LastLookupFrame(INDEX_NONE)
+	, NumWorkers(FMath::Max(1, InNumWorkers))
+	, PrefetchDepth(FMath::Clamp(FMath::Max(InPrefetchDepth, NumWorkers), 1, FMath::Max(1, InSequenceIndex->GetNumFrames())))
+	, PreviewFrame(INDEX_NONE)
+	, RequestedFrame(0)
+	, Scheduler(InScheduler)
+	, Sequence(InSequenceIndex->GetSequencePath())
+	, SequenceIndex(InSequenceIndex)
+	, Stats(InStats)
+{
+	if (SequenceIndex->IsPacked())
+	{
+		Container.Reset(new FExrMappedFile(Sequence));
+
+		if (!Container->IsValid())
+		{
+			UE_LOG(LogExrMedia, Error, TEXT("Failed to map sequence container %s"), *Sequence);
+		}
+	}
+
+	Scheduler->Register(*this);
+
+	FScopeLock Lock(&CriticalSection);
+	QueueWork();
+}
+
+
+FExrMediaLoader::~FExrMediaLoader()
+{
+	// abandons queued work and waits for running work to finish; work that
+	// is queued by finishing work items during shutdown is abandoned as well
+	Scheduler->Unregister(*this);
+}
+
+
+/* FExrMediaLoader interface
+ *****************************************************************************/
+
+double FExrMediaLoader::GetAverageDecodeTime() const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	return AverageDecodeTime;
+}
+
+
+void FExrMediaLoader::GetCacheStats(int32& OutNumFrames, SIZE_T& OutSize, SIZE_T& OutBudget, uint64& OutNumHits, uint64& OutNumMisses, uint64& OutNumEvictions) const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	OutNumFrames = Cache.GetNumFrames();
+	OutSize = Cache.GetSize();
+	OutBudget = Cache.GetBudget();
+	OutNumHits = Cache.GetNumHits();
+	OutNumMisses = Cache.GetNumMisses();
+	OutNumEvictions = Cache.GetNumEvictions();
+}
+
+
+void FExrMediaLoader::GetPrefetchStats(int32& OutNumQueued, int32& OutNumReady, int32& OutWindowSize) const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	OutNumQueued = QueuedFrames.Num();
+	OutNumReady = 0;
+	OutWindowSize = GetWindowSize();
+
+	for (int32 Offset = 0; Offset < OutWindowSize; ++Offset)
+	{
+		if (Cache.Contains(FExrMediaFrameCacheKey(Sequence, GetWindowFrame(Offset))))
+		{
+			++OutNumReady;
+		}
+	}
+}
+
+
+int32 FExrMediaLoader::GetNumFrames() const
+{
+	return SequenceIndex->GetNumFrames();
+}
+
+
+TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> FExrMediaLoader::GetFrame(int32 FrameIndex)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	const FExrMediaFrameCacheKey Key(Sequence, FrameIndex);
+
+	// only the first lookup of a frame counts as a cache hit or miss
+	if (FrameIndex == LastLookupFrame)
+	{
+		return Cache.Peek(Key);
+	}
+
+	LastLookupFrame = FrameIndex;
+
+	return Cache.Find(Key);
+}
+
+
+TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> FExrMediaLoader::GetPreviewFrame(int32 FrameIndex) const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	if (Preview.IsValid() && (Preview->FrameIndex == FrameIndex))
+	{
+		return Preview;
+	}
+
+	return nullptr;
+}
+
+
+bool FExrMediaLoader::IsFrameWanted(int32 FrameIndex, int32 FrameGeneration) const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	if (FrameGeneration != Generation)
+	{
+		return false;
+	}
+
+	const int32 WindowSize = GetWindowSize();
+
+	for (int32 Offset = 0; Offset < WindowSize; ++Offset)
+	{
+		if (GetWindowFrame(Offset) == FrameIndex)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void FExrMediaLoader::NotifyPreviewComplete(int32 FrameIndex, const TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe>& Frame, int32 FrameGeneration)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	// previews are only useful while their frame is at the play head
+	if ((FrameGeneration == Generation) && (FrameIndex == RequestedFrame))
+	{
+		Preview = Frame;
+	}
+}
+
+
+void FExrMediaLoader::NotifyWorkCancelled(int32 FrameIndex)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	QueuedFrames.Remove(FrameIndex);
+
+	QueueWork();
+}
+
+
+void FExrMediaLoader::NotifyWorkComplete(int32 FrameIndex, const TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe>& Frame, int32 FrameGeneration, const FExrMediaDecodeTimings& Timings)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	QueuedFrames.Remove(FrameIndex);
+
+	// frames decoded with outdated options are dropped
+	if (FrameGeneration == Generation)
+	{
+		if (Frame.IsValid())
+		{
+			Cache.Add(FExrMediaFrameCacheKey(Sequence, FrameIndex), Frame);
+			LastFrameSize = Frame->Data.Num();
+			AverageDecodeTime = (AverageDecodeTime > 0.0) ? FMath::Lerp(AverageDecodeTime, Timings.GetTotalTime(), 0.1) : Timings.GetTotalTime();
+			Stats.AddDecodedFrame(Timings);
+		}
+		else
+		{
+			FailedFrames.Add(FrameIndex);
+		}
+	}
+
+	QueueWork();
+}
+
+
+TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> FExrMediaLoader::PeekFrame(int32 FrameIndex) const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	return Cache.Peek(FExrMediaFrameCacheKey(Sequence, FrameIndex));
+}
+
+
+void FExrMediaLoader::RequestFrame(int32 FrameIndex)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	if (FrameIndex == RequestedFrame)
+	{
+		return;
+	}
+
+	RequestedFrame = FrameIndex;
+
+	QueueWork();
+}
+
+
+void FExrMediaLoader::Seek(int32 FrameIndex, bool WithPreview)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	Preview.Reset();
+	PreviewFrame = WithPreview ? FrameIndex : INDEX_NONE;
+	RequestedFrame = FrameIndex;
+
+	QueueWork();
+}
+
+
+void FExrMediaLoader::SetDecodeOptions(const FExrMediaDecodeOptions& InDecodeOptions)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	AverageDecodeTime = 0.0;
+	Cache.Empty();
+	DecodeOptions = InDecodeOptions;
+	FailedFrames.Empty();
+	LastFrameSize = 0;
+	LastLookupFrame = INDEX_NONE;
+	Preview.Reset();
+
+	++Generation;
+
+	QueueWork();
+}
+
+
+void FExrMediaLoader::SetDirection(int32 InDirection)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	const int32 NewDirection = (InDirection < 0) ? -1 : 1;
+
+	if (NewDirection == Direction)
+	{
+		return;
+	}
+
+	// recently displayed frames are still cached, so the new window starts out warm
+	Direction = NewDirection;
+
+	QueueWork();
+}
+
+
+void FExrMediaLoader::SetFrameRate(double FramesPerSecond)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	FrameInterval = (FramesPerSecond > 0.0) ? (1.0 / FramesPerSecond) : (1.0 / 24.0);
+}
+
+
+void FExrMediaLoader::SetFrameStep(int32 InFrameStep)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	FrameStep = FMath::Max(1, InFrameStep);
+
+	QueueWork();
+}
+
+
+/* FExrMediaLoader implementation
+ *****************************************************************************/
+
+int32 FExrMediaLoader::GetWindowFrame(int32 Offset) const
+{
+	const int32 NumFrames = SequenceIndex->GetNumFrames();
+	const int32 FrameIndex = (RequestedFrame + Direction * Offset * FrameStep) % NumFrames;
+
+	return (FrameIndex < 0) ? (FrameIndex + NumFrames) : FrameIndex;
+}
+
+
+int32 FExrMediaLoader::GetWindowSize() const
+{
+	// never prefetch more frames than fit into the cache, or frames
+	// in the prefetch window would evict each other before display
+	if (LastFrameSize > 0)
+	{
+		return FMath::Clamp((int32)(Cache.GetBudget() / LastFrameSize), 1, PrefetchDepth);
+	}
+
+	return PrefetchDepth;
+}
+
+
+void FExrMediaLoader::QueueWork()
+{
+	// the loader's share of the memory budget changes as other players open and close
+	const SIZE_T CacheBudget = Scheduler->GetCacheBudget();
+
+	if (CacheBudget != Cache.GetBudget())
+	{
+		Cache.SetBudget(CacheBudget);
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	const int32 WindowSize = GetWindowSize();
+
+	// frames of a previous window (i.e. before a seek) are dropped by their work
+	// items, so only frames in the current window count towards the limit
+	int32 NumWindowFrames = 0;
+
+	for (int32 Offset = 0; Offset < WindowSize; ++Offset)
+	{
+		if (QueuedFrames.Contains(GetWindowFrame(Offset)))
+		{
+			++NumWindowFrames;
+		}
+	}
+
+	// frames closest to the play head are queued first; the frame at the play head
+	// is always queued, and may take the scheduler's reserved thread if all of
+	// its workers are busy with frames further ahead
+	for (int32 Offset = 0; (Offset < WindowSize) && ((Offset == 0) || (NumWindowFrames < NumWorkers)); ++Offset)
+	{
+		const int32 FrameIndex = GetWindowFrame(Offset);
+
+		if (Cache.Contains(FExrMediaFrameCacheKey(Sequence, FrameIndex)) || QueuedFrames.Contains(FrameIndex) || FailedFrames.Contains(FrameIndex))
+		{
+			continue;
+		}
+
+		// the frame at the play head is needed right away (i.e. after a seek or while
+		// scrubbing), so it is decoded either with all of OpenEXR's intra-frame threads,
+		// or in stripes with one input file each that are decoded by ParallelFor
+		int32 NumStripes = 1;
+		int32 NumThreads = 0;
+
+		if (Offset == 0)
+		{
+			if (DecodeOptions.NumStripes > 1)
+			{
+				NumStripes = DecodeOptions.NumStripes;
+			}
+			else
+			{
+				NumThreads = FRgbaInputFile::GetGlobalThreadCount();
+			}
+		}
+
+		const bool WithPreview = (FrameIndex == PreviewFrame);
+
+		if (WithPreview)
+		{
+			PreviewFrame = INDEX_NONE;
+		}
+
+		const double Deadline = Now + Offset * FrameStep * FrameInterval;
+
+		QueuedFrames.Add(FrameIndex);
+		++NumWindowFrames;
+
+		Scheduler->AddWork(*this, new FExrMediaLoaderWork(*this, FrameIndex, SequenceIndex->GetImagePath(FrameIndex), SequenceIndex->GetFrameInfo(FrameIndex), Container.Get(), DecodeOptions, Generation, NumThreads, NumStripes, WithPreview), Deadline, Offset == 0);
+	}
+}
+
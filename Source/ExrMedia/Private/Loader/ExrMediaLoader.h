@@ -0,0 +1,350 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "Containers/Map.h"
+#include "Containers/Set.h"
+#include "Containers/UnrealString.h"
+#include "HAL/CriticalSection.h"
+#include "Math/IntPoint.h"
+#include "Templates/SharedPointer.h"
+#include "Templates/UniquePtr.h"
+
+#include "ExrMediaDecodeOptions.h"
+#include "ExrMediaFrame.h"
+#include "ExrMediaFrameCache.h"
+
+class FExrMappedFile;
+class FExrMediaDecodeScheduler;
+class FExrMediaPlaybackStats;
+class FExrMediaSequenceIndex;
+struct FExrMediaDecodeTimings;
+
+
+/**
+ * Loads EXR image sequence frames ahead of the play head on the shared decoder threads.
+ *
+ * The loader keeps a window of decoded frames that starts at the most recently
+ * requested frame and extends PrefetchDepth frames in the playback direction,
+ * so that reverse playback is prefetched just like forward playback. The window
+ * wraps around at either end of the sequence, so that looping playback does not
+ * stall on the first or last frame.
+ *
+ * Up to NumWorkers frames are queued at the same time, each by its own work
+ * item with its own input file. Work items are run by the decode scheduler that
+ * all loaders share, in the order of the times at which their frames are due.
+ * Frames may finish in any order; they are stored by frame index and handed out
+ * in play order through GetFrame. The frame at the play head is never kept waiting
+ * for a worker: it may take the scheduler's reserved thread, and queued frames that
+ * left the prefetch window since they were queued (i.e. after a seek) are cancelled
+ * before they are decoded.
+ *
+ * Decoded frames are kept in a frame cache whose memory budget is the loader's
+ * share of the scheduler's budget, so that frames that are played again (i.e. when
+ * looping or scrubbing) are not decoded again as long as they have not been evicted.
+ *
+ * Packed sequences are mapped into memory once, and all frames are decoded from
+ * their byte ranges in that mapping.
+ */
+class FExrMediaLoader
+{
+public:
+
+	/**
+	 * Create and initialize a new instance.
+	 *
+	 * @param InSequenceIndex Header index of the image sequence to load.
+	 * @param InScheduler The decode scheduler to run work items on.
+	 * @param InPrefetchDepth Number of frames to decode ahead of the play head (at least InNumWorkers).
+	 * @param InNumWorkers Maximum number of frames to decode in parallel.
+	 * @param InDecodeOptions Options that control how frames are decoded.
+	 * @param InStats The playback statistics to report decode timings to (must outlive the loader).
+	 */
+	FExrMediaLoader(const TSharedRef<FExrMediaSequenceIndex, ESPMode::ThreadSafe>& InSequenceIndex, const TSharedRef<FExrMediaDecodeScheduler, ESPMode::ThreadSafe>& InScheduler, int32 InPrefetchDepth, int32 InNumWorkers, const FExrMediaDecodeOptions& InDecodeOptions, FExrMediaPlaybackStats& InStats);
+
+	/** Destructor. */
+	~FExrMediaLoader();
+
+public:
+
+	/**
+	 * Get the average time that it took to decode a frame with the current decode options.
+	 *
+	 * @return Decode time (in seconds, 0.0 = no frame decoded yet).
+	 */
+	double GetAverageDecodeTime() const;
+
+	/**
+	 * Get the direction in which frames are prefetched.
+	 *
+	 * @return 1 if frames are prefetched forward, -1 if backward.
+	 * @see SetDirection
+	 */
+	int32 GetDirection() const
+	{
+		return Direction;
+	}
+
+	/**
+	 * Get the frame cache's statistics.
+	 *
+	 * @param OutNumFrames Will contain the number of cached frames.
+	 * @param OutSize Will contain the number of bytes of cached frame data.
+	 * @param OutBudget Will contain the cache's memory budget (in bytes).
+	 * @param OutNumHits Will contain the number of frames that were ready when first requested.
+	 * @param OutNumMisses Will contain the number of frames that were not ready when first requested.
+	 * @param OutNumEvictions Will contain the number of frames evicted from the cache.
+	 */
+	void GetCacheStats(int32& OutNumFrames, SIZE_T& OutSize, SIZE_T& OutBudget, uint64& OutNumHits, uint64& OutNumMisses, uint64& OutNumEvictions) const;
+
+	/**
+	 * Get the occupancy of the prefetch window.
+	 *
+	 * @param OutNumQueued Will contain the number of frames that are being decoded.
+	 * @param OutNumReady Will contain the number of decoded frames in the prefetch window.
+	 * @param OutWindowSize Will contain the number of frames in the prefetch window.
+	 */
+	void GetPrefetchStats(int32& OutNumQueued, int32& OutNumReady, int32& OutWindowSize) const;
+
+	/**
+	 * Get the decoded frame with the specified index.
+	 *
+	 * @param FrameIndex Index of the frame to get.
+	 * @return The frame, or nullptr if it hasn't been decoded yet.
+	 * @see RequestFrame
+	 */
+	TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> GetFrame(int32 FrameIndex);
+
+	/**
+	 * Get the number of frames in the image sequence.
+	 *
+	 * @return Number of frames.
+	 */
+	int32 GetNumFrames() const;
+
+	/**
+	 * Get the maximum number of frames that are decoded in parallel.
+	 *
+	 * @return Number of decoder workers.
+	 */
+	int32 GetNumWorkers() const
+	{
+		return NumWorkers;
+	}
+
+	/**
+	 * Get the low resolution preview of the specified frame.
+	 *
+	 * @param FrameIndex Index of the frame whose preview to get.
+	 * @return The preview, or nullptr if no preview of the frame was decoded.
+	 * @see Seek
+	 */
+	TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> GetPreviewFrame(int32 FrameIndex) const;
+
+	/**
+	 * Check whether a queued frame is still needed.
+	 *
+	 * This method is called on a decoder thread.
+	 *
+	 * @param FrameIndex Index of the queued frame.
+	 * @param FrameGeneration The decode options generation that the frame was queued with.
+	 * @return true if the frame is in the prefetch window, false if its work should be cancelled.
+	 */
+	bool IsFrameWanted(int32 FrameIndex, int32 FrameGeneration) const;
+
+	/**
+	 * Notify the loader that a preview of a frame finished decoding.
+	 *
+	 * This method is called on a decoder thread.
+	 *
+	 * @param FrameIndex Index of the frame.
+	 * @param Frame The decoded preview.
+	 * @param FrameGeneration The decode options generation that the preview was decoded with.
+	 */
+	void NotifyPreviewComplete(int32 FrameIndex, const TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe>& Frame, int32 FrameGeneration);
+
+	/**
+	 * Notify the loader that a queued frame was cancelled before it was decoded.
+	 *
+	 * This method is called on a decoder thread.
+	 *
+	 * @param FrameIndex Index of the cancelled frame.
+	 * @see IsFrameWanted
+	 */
+	void NotifyWorkCancelled(int32 FrameIndex);
+
+	/**
+	 * Notify the loader that a frame finished decoding.
+	 *
+	 * This method is called on a decoder thread.
+	 *
+	 * @param FrameIndex Index of the decoded frame.
+	 * @param Frame The decoded frame, or nullptr if decoding failed.
+	 * @param FrameGeneration The decode options generation that the frame was decoded with.
+	 * @param Timings Time spent in each stage of decoding the frame.
+	 */
+	void NotifyWorkComplete(int32 FrameIndex, const TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe>& Frame, int32 FrameGeneration, const FExrMediaDecodeTimings& Timings);
+
+	/**
+	 * Get the decoded frame with the specified index without counting it as a cache access.
+	 *
+	 * @param FrameIndex Index of the frame to get.
+	 * @return The frame, or nullptr if it hasn't been decoded yet.
+	 * @see GetFrame
+	 */
+	TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> PeekFrame(int32 FrameIndex) const;
+
+	/**
+	 * Move the prefetch window to the specified frame.
+	 *
+	 * @param FrameIndex Index of the frame that is about to be displayed.
+	 * @see GetFrame
+	 */
+	void RequestFrame(int32 FrameIndex);
+
+	/**
+	 * Move the prefetch window to the specified frame after a seek.
+	 *
+	 * The frame is decoded before all other frames in the window, and queued frames
+	 * that are no longer in the window are cancelled. Optionally, a low resolution
+	 * preview of the frame is decoded first if that is much cheaper than the frame.
+	 *
+	 * @param FrameIndex Index of the frame to seek to.
+	 * @param WithPreview Whether to decode a preview of the frame first.
+	 * @see GetPreviewFrame
+	 */
+	void Seek(int32 FrameIndex, bool WithPreview);
+
+	/**
+	 * Change the options that frames are decoded with.
+	 *
+	 * All cached frames are discarded, and frames that are still being
+	 * decoded with the previous options are dropped when they complete.
+	 *
+	 * @param InDecodeOptions The new decode options.
+	 */
+	void SetDecodeOptions(const FExrMediaDecodeOptions& InDecodeOptions);
+
+	/**
+	 * Set the direction in which frames are prefetched.
+	 *
+	 * @param InDirection The playback direction (>= 0 = forward, < 0 = backward).
+	 * @see GetDirection
+	 */
+	void SetDirection(int32 InDirection);
+
+	/**
+	 * Set the rate at which frames are displayed.
+	 *
+	 * The rate determines the times at which prefetched frames are due,
+	 * which the decode scheduler uses to order work of all loaders.
+	 *
+	 * @param FramesPerSecond The display rate (in frames per second).
+	 */
+	void SetFrameRate(double FramesPerSecond);
+
+	/**
+	 * Set the number of frames to advance between prefetched frames.
+	 *
+	 * @param InFrameStep Frame step (1 = prefetch every frame).
+	 */
+	void SetFrameStep(int32 InFrameStep);
+
+protected:
+
+	/**
+	 * Get the number of frames in the prefetch window.
+	 *
+	 * The caller must hold the critical section.
+	 *
+	 * @return Window size.
+	 */
+	int32 GetWindowSize() const;
+
+	/**
+	 * Get the index of the frame at the specified position in the prefetch window.
+	 *
+	 * The caller must hold the critical section.
+	 *
+	 * @param Offset Position in the window (0 = most recently requested frame).
+	 * @return Frame index.
+	 */
+	int32 GetWindowFrame(int32 Offset) const;
+
+	/**
+	 * Queue decoder work for frames in the prefetch window that are neither loaded nor being loaded.
+	 *
+	 * The caller must hold the critical section.
+	 */
+	void QueueWork();
+
+private:
+
+	/** Critical section for synchronizing access to the frame cache. */
+	mutable FCriticalSection CriticalSection;
+
+	/** Exponential moving average of the time it took to decode a frame (in seconds). */
+	double AverageDecodeTime;
+
+	/** Cache of decoded frames. */
+	FExrMediaFrameCache Cache;
+
+	/** Memory mapping of the sequence container file (only for packed sequences). */
+	TUniquePtr<FExrMappedFile> Container;
+
+	/** Options that control how frames are decoded. */
+	FExrMediaDecodeOptions DecodeOptions;
+
+	/** Direction in which frames are prefetched (1 = forward, -1 = backward). */
+	int32 Direction;
+
+	/** Time between displayed frames (in seconds). */
+	double FrameInterval;
+
+	/** Indices of frames that failed to decode and will not be queued again. */
+	TSet<int32> FailedFrames;
+
+	/** Number of frames to advance between prefetched frames. */
+	int32 FrameStep;
+
+	/** Generation of the decode options, incremented whenever they change. */
+	int32 Generation;
+
+	/** Size of the most recently decoded frame (in bytes). */
+	SIZE_T LastFrameSize;
+
+	/** Index of the most recently looked up frame. */
+	int32 LastLookupFrame;
+
+	/** Maximum number of frames to decode in parallel. */
+	int32 NumWorkers;
+
+	/** Number of frames to decode ahead of the play head. */
+	int32 PrefetchDepth;
+
+	/** The most recently decoded seek preview. */
+	TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> Preview;
+
+	/** Index of the frame to decode a preview of before the frame itself (INDEX_NONE = none). */
+	int32 PreviewFrame;
+
+	/** Indices of frames that are currently being decoded. */
+	TSet<int32> QueuedFrames;
+
+	/** Index of the most recently requested frame. */
+	int32 RequestedFrame;
+
+	/** Identifies the image sequence in the frame cache. */
+	FString Sequence;
+
+	/** The decode scheduler that runs the work items. */
+	TSharedRef<FExrMediaDecodeScheduler, ESPMode::ThreadSafe> Scheduler;
+
+	/** Header index of the image sequence. */
+	TSharedRef<FExrMediaSequenceIndex, ESPMode::ThreadSafe> SequenceIndex;
+
+	/** The playback statistics to report decode timings to. */
+	FExrMediaPlaybackStats& Stats;
+};
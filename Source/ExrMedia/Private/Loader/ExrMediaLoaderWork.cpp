@@ -0,0 +1,544 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "ExrMediaLoaderWork.h"
+#include "ExrMediaPrivate.h"
+
+#include "Async/ParallelFor.h"
+#include "ExrMediaDownsample.h"
+#include "ExrMediaFrame.h"
+#include "ExrMediaLoader.h"
+#include "ExrMediaPackFloat.h"
+#include "ExrMediaStats.h"
+#include "ExrMediaToneMap.h"
+#include "ExrMediaTrace.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "OpenExrWrapper.h"
+#include "Templates/UniquePtr.h"
+
+
+DECLARE_CYCLE_STAT(TEXT("Decode Frame"), STAT_ExrMedia_DecodeFrame, STATGROUP_ExrMedia);
+DECLARE_CYCLE_STAT(TEXT("Open File"), STAT_ExrMedia_OpenFile, STATGROUP_ExrMedia);
+DECLARE_CYCLE_STAT(TEXT("Parse Header"), STAT_ExrMedia_ParseHeader, STATGROUP_ExrMedia);
+DECLARE_CYCLE_STAT(TEXT("Read Pixels"), STAT_ExrMedia_ReadPixels, STATGROUP_ExrMedia);
+DECLARE_CYCLE_STAT(TEXT("Convert Frame"), STAT_ExrMedia_ConvertFrame, STATGROUP_ExrMedia);
+DECLARE_CYCLE_STAT(TEXT("Decode Preview"), STAT_ExrMedia_DecodePreview, STATGROUP_ExrMedia);
+
+
+/** Proxy level at which seek previews are decoded (mip level, or subsampling by 2^level). */
+static const int32 ExrMediaPreviewLevel = 2;
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/** Open an RGBA input file, which always reads the first part. */
+static void ExrMediaOpenInputFile(TUniquePtr<FRgbaInputFile>& OutInputFile, const FString& ImagePath, const FExrMappedFile* MappedFile, int32 Part, int32 NumThreads)
+{
+	OutInputFile.Reset((MappedFile != nullptr)
+		? new FRgbaInputFile(*MappedFile, NumThreads)
+		: new FRgbaInputFile(ImagePath, NumThreads));
+}
+
+
+/** Open a channel input file that reads the specified part. */
+static void ExrMediaOpenInputFile(TUniquePtr<FChannelInputFile>& OutInputFile, const FString& ImagePath, const FExrMappedFile* MappedFile, int32 Part, int32 NumThreads)
+{
+	OutInputFile.Reset((MappedFile != nullptr)
+		? new FChannelInputFile(*MappedFile, Part, NumThreads)
+		: new FChannelInputFile(ImagePath, Part, NumThreads));
+}
+
+
+/** Set the frame buffer of an RGBA input file, which always decodes RGBA pixels. */
+static bool ExrMediaSetFrameBuffer(FRgbaInputFile& InputFile, FExrMediaFrame& Frame, const TArray<FString>& ChannelNames)
+{
+	return InputFile.SetFrameBuffer(Frame.Data.GetData(), Frame.Dim);
+}
+
+
+/** Set the frame buffer of a channel input file to the given channels, or RGBA if none are given. */
+static bool ExrMediaSetFrameBuffer(FChannelInputFile& InputFile, FExrMediaFrame& Frame, const TArray<FString>& ChannelNames)
+{
+	if (ChannelNames.Num() > 0)
+	{
+		return InputFile.SetFrameBuffer(Frame.Data.GetData(), Frame.Dim, ChannelNames);
+	}
+
+	return InputFile.SetFrameBuffer(Frame.Data.GetData(), Frame.Dim);
+}
+
+
+/**
+ * Decode a range of rows of an image file into a frame.
+ *
+ * @param InputFileType The type of input file to decode with (FChannelInputFile or FRgbaInputFile).
+ */
+template<typename InputFileType>
+bool ExrMediaReadRows(const FString& ImagePath, const FExrMappedFile* MappedFile, int32 Part, int32 NumThreads, const TArray<FString>& ChannelNames, FExrMediaFrame& Frame, int32 StartY, int32 EndY, double& OutHeaderTime)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	TUniquePtr<InputFileType> InputFile;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ExrMedia_ParseHeader);
+		EXRMEDIA_TRACE_SCOPE("Parse Header", Frame.FrameIndex);
+
+		ExrMediaOpenInputFile(InputFile, ImagePath, MappedFile, Part, NumThreads);
+	}
+
+	OutHeaderTime = FPlatformTime::Seconds() - StartTime;
+
+	// the wrapper has already logged why the file could not be opened
+	if (!InputFile->IsValid())
+	{
+		return false;
+	}
+
+	// the image file may have changed since the sequence was indexed
+	if (InputFile->GetDataWindow() != Frame.Dim)
+	{
+		UE_LOG(LogExrMedia, Warning, TEXT("Image file %s is no longer %s"), *ImagePath, *Frame.Dim.ToString());
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ExrMedia_ReadPixels);
+	EXRMEDIA_TRACE_SCOPE("Read Pixels", Frame.FrameIndex);
+
+	return ExrMediaSetFrameBuffer(*InputFile, Frame, ChannelNames) && InputFile->ReadPixels(StartY, EndY);
+}
+
+
+/**
+ * Decode an image file into a frame of reduced resolution.
+ *
+ * @param InputFileType The type of input file to decode with (FChannelInputFile or FRgbaInputFile).
+ */
+template<typename InputFileType>
+bool ExrMediaReadSubsampled(const FString& ImagePath, const FExrMappedFile* MappedFile, int32 NumThreads, const FExrMediaFrameInfo& FrameInfo, int32 Factor, FExrMediaFrame& Frame, double& OutHeaderTime)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	TUniquePtr<InputFileType> InputFile;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ExrMedia_ParseHeader);
+		EXRMEDIA_TRACE_SCOPE("Parse Header", Frame.FrameIndex);
+
+		InputFile.Reset((MappedFile != nullptr)
+			? new InputFileType(*MappedFile, NumThreads)
+			: new InputFileType(ImagePath, NumThreads));
+	}
+
+	OutHeaderTime = FPlatformTime::Seconds() - StartTime;
+
+	if (!InputFile->IsValid())
+	{
+		return false;
+	}
+
+	const FIntPoint SourceDim = FrameInfo.Dim;
+
+	if (InputFile->GetDataWindow() != SourceDim)
+	{
+		UE_LOG(LogExrMedia, Warning, TEXT("Image file %s is no longer %s"), *ImagePath, *SourceDim.ToString());
+		return false;
+	}
+
+	const int32 LinesPerBlock = FMath::Max(1, FrameInfo.LinesPerBlock);
+	const int32 SourcePitch = SourceDim.X * 4;
+
+	SCOPE_CYCLE_COUNTER(STAT_ExrMedia_ReadPixels);
+	EXRMEDIA_TRACE_SCOPE("Read Pixels", Frame.FrameIndex);
+
+	TArray<uint16> Rows;
+	Rows.AddUninitialized(SourcePitch * Factor);
+
+	uint16* Dest = (uint16*)Frame.Data.GetData();
+
+	for (int32 DestY = 0; DestY < Frame.Dim.Y; ++DestY, Dest += Frame.Dim.X * 4)
+	{
+		const int32 StartY = DestY * Factor;
+		const int32 NumRows = FMath::Min3(Factor, LinesPerBlock - (StartY % LinesPerBlock), SourceDim.Y - StartY);
+
+		// the frame buffer is positioned so that the requested rows land in the row buffer
+		if (!InputFile->SetFrameBuffer(Rows.GetData() - StartY * SourcePitch, SourceDim) || !InputFile->ReadPixels(StartY, StartY + NumRows - 1))
+		{
+			return false;
+		}
+
+		ExrMedia::DownsampleRow(Rows.GetData(), SourceDim.X, NumRows, Factor, Dest);
+	}
+
+	return true;
+}
+
+
+/* FExrMediaLoaderWork structors
+ *****************************************************************************/
+
+FExrMediaLoaderWork::FExrMediaLoaderWork(FExrMediaLoader& InOwner, int32 InFrameIndex, const FString& InImagePath, const FExrMediaFrameInfo& InFrameInfo, const FExrMappedFile* InContainer, const FExrMediaDecodeOptions& InDecodeOptions, int32 InGeneration, int32 InNumThreads, int32 InNumStripes, bool InPreview)
+	: Container(InContainer)
+	, DecodeOptions(InDecodeOptions)
+	, FrameIndex(InFrameIndex)
+	, FrameInfo(InFrameInfo)
+	, Generation(InGeneration)
+	, ImagePath(InImagePath)
+	, NumStripes(FMath::Max(1, InNumStripes))
+	, NumThreads(InNumThreads)
+	, Owner(InOwner)
+	, Preview(InPreview)
+{ }
+
+
+/* IQueuedWork interface
+ *****************************************************************************/
+
+void FExrMediaLoaderWork::Abandon()
+{
+	delete this;
+}
+
+
+void FExrMediaLoaderWork::DoThreadedWork()
+{
+	// frames that left the prefetch window while queued (i.e. after a seek) are not decoded
+	if (!Owner.IsFrameWanted(FrameIndex, Generation))
+	{
+		UE_LOG(LogExrMedia, VeryVerbose, TEXT("Cancelled frame %i"), FrameIndex);
+		Owner.NotifyWorkCancelled(FrameIndex);
+
+		delete this;
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ExrMedia_DecodeFrame);
+	EXRMEDIA_TRACE_SCOPE("Decode Frame", FrameIndex);
+
+	const double StartTime = FPlatformTime::Seconds();
+	FExrMediaDecodeTimings Timings;
+
+	// compressed line blocks are decoded straight from the mapped pages
+	TUniquePtr<FExrMappedFile> MappedFile;
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ExrMedia_OpenFile);
+		EXRMEDIA_TRACE_SCOPE("Open File", FrameIndex);
+
+		if (FrameInfo.Offset > 0)
+		{
+			// frames of packed sequences can only be read from the container
+			if (Container != nullptr)
+			{
+				MappedFile.Reset(new FExrMappedFile(*Container, FrameInfo.Offset, FrameInfo.FileSize, ImagePath));
+			}
+
+			if (!MappedFile.IsValid() || !MappedFile->IsValid())
+			{
+				UE_LOG(LogExrMedia, Warning, TEXT("Frame %i is not available in its sequence container"), FrameIndex);
+				Owner.NotifyWorkComplete(FrameIndex, nullptr, Generation, Timings);
+
+				delete this;
+				return;
+			}
+		}
+		else if (DecodeOptions.MemoryMapped)
+		{
+			MappedFile.Reset(new FExrMappedFile(ImagePath));
+
+			if (!MappedFile->IsValid())
+			{
+				UE_LOG(LogExrMedia, Verbose, TEXT("Failed to map %s, reading file instead"), *ImagePath);
+				MappedFile.Reset();
+			}
+		}
+	}
+
+	Timings.OpenTime = FPlatformTime::Seconds() - StartTime;
+
+	if (Preview)
+	{
+		DecodePreview(MappedFile.Get());
+	}
+
+	TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> Frame = DecodeFrame(MappedFile.Get(), Timings);
+	const int32 MipLevel = FMath::Min(DecodeOptions.MipLevel, FrameInfo.NumMipLevels - 1);
+
+	UE_LOG(LogExrMedia, VeryVerbose, TEXT("Loaded frame %i (%s) at mip level %i with %i threads in %i stripes%s"), FrameIndex, *ImagePath, MipLevel, NumThreads, NumStripes, DecodeOptions.DirectChannels ? TEXT(" (direct)") : TEXT(""));
+
+	Owner.NotifyWorkComplete(FrameIndex, Frame, Generation, Timings);
+
+	delete this;
+}
+
+
+/* FExrMediaLoaderWork implementation
+ *****************************************************************************/
+
+TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> FExrMediaLoaderWork::DecodeFrame(const FExrMappedFile* MappedFile, FExrMediaDecodeTimings& InOutTimings) const
+{
+	const double DecodeStartTime = FPlatformTime::Seconds();
+
+	TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> Frame = MakeShareable(new FExrMediaFrame());
+	int32 NumChannels = 4;
+
+	// proxy levels are read from tiled images as a whole
+	const int32 MipLevel = FMath::Min(DecodeOptions.MipLevel, FrameInfo.NumMipLevels - 1);
+
+	if (MipLevel > 0)
+	{
+		Frame->FrameIndex = FrameIndex;
+
+		if (!ReadMipLevel(*Frame, MappedFile, MipLevel, InOutTimings.HeaderTime))
+		{
+			Frame.Reset();
+		}
+	}
+	else if (DecodeOptions.SubsampleFactor > 1)
+	{
+		Frame->Dim = FIntPoint(
+			FMath::DivideAndRoundUp(FrameInfo.Dim.X, DecodeOptions.SubsampleFactor),
+			FMath::DivideAndRoundUp(FrameInfo.Dim.Y, DecodeOptions.SubsampleFactor)
+		);
+
+		Frame->FrameIndex = FrameIndex;
+		Frame->Data.AddUninitialized(Frame->Dim.X * Frame->Dim.Y * 4 * sizeof(uint16));
+
+		if (!ReadSubsampled(*Frame, MappedFile, InOutTimings.HeaderTime))
+		{
+			Frame.Reset();
+		}
+	}
+	else
+	{
+		// the sequence index provides the frame layout, so that the
+		// frame buffer can be allocated before the image file is opened
+		Frame->Dim = FrameInfo.Dim;
+		Frame->FrameIndex = FrameIndex;
+
+		// each pixel is four 16-bit floats, unless constant channels are skipped
+		if (DecodeOptions.ChannelNames.Num() > 0)
+		{
+			NumChannels = DecodeOptions.ChannelNames.Num();
+		}
+
+		Frame->Data.AddUninitialized(Frame->Dim.X * Frame->Dim.Y * NumChannels * sizeof(uint16));
+
+		const bool Succeeded = (NumStripes > 1)
+			? ReadStripes(*Frame, MappedFile, InOutTimings.HeaderTime)
+			: ReadRows(*Frame, MappedFile, NumThreads, 0, Frame->Dim.Y - 1, InOutTimings.HeaderTime);
+
+		if (!Succeeded)
+		{
+			Frame.Reset();
+		}
+	}
+
+	const double ConvertStartTime = FPlatformTime::Seconds();
+	InOutTimings.DecompressTime = ConvertStartTime - DecodeStartTime - InOutTimings.HeaderTime;
+
+	if (Frame.IsValid())
+	{
+		ConvertFrame(*Frame, NumChannels);
+		Frame->TrackMemory();
+
+		InOutTimings.BytesRead = FrameInfo.FileSize;
+		InOutTimings.ConvertTime = FPlatformTime::Seconds() - ConvertStartTime;
+	}
+
+	return Frame;
+}
+
+
+void FExrMediaLoaderWork::DecodePreview(const FExrMappedFile* MappedFile)
+{
+	// frames that are already decoded at a proxy level are cheap enough
+	if ((DecodeOptions.MipLevel > 0) || (DecodeOptions.SubsampleFactor > 1))
+	{
+		return;
+	}
+
+	FExrMediaDecodeOptions PreviewOptions = DecodeOptions;
+
+	if (FrameInfo.NumMipLevels > 1)
+	{
+		PreviewOptions.MipLevel = FMath::Min(ExrMediaPreviewLevel, FrameInfo.NumMipLevels - 1);
+	}
+	else if (FrameInfo.LinesPerBlock == 1)
+	{
+		PreviewOptions.SubsampleFactor = 1 << ExrMediaPreviewLevel;
+	}
+	else
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ExrMedia_DecodePreview);
+	EXRMEDIA_TRACE_SCOPE("Decode Preview", FrameIndex);
+
+	FExrMediaDecodeTimings PreviewTimings;
+	TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> PreviewFrame;
+	{
+		TGuardValue<FExrMediaDecodeOptions> DecodeOptionsGuard(DecodeOptions, PreviewOptions);
+		PreviewFrame = DecodeFrame(MappedFile, PreviewTimings);
+	}
+
+	if (PreviewFrame.IsValid())
+	{
+		Owner.NotifyPreviewComplete(FrameIndex, PreviewFrame, Generation);
+	}
+}
+
+
+bool FExrMediaLoaderWork::ReadMipLevel(FExrMediaFrame& Frame, const FExrMappedFile* MappedFile, int32 Level, double& OutHeaderTime) const
+{
+	const double StartTime = FPlatformTime::Seconds();
+	TUniquePtr<FTiledRgbaInputFile> InputFile;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ExrMedia_ParseHeader);
+		EXRMEDIA_TRACE_SCOPE("Parse Header", Frame.FrameIndex);
+
+		InputFile.Reset((MappedFile != nullptr)
+			? new FTiledRgbaInputFile(*MappedFile, NumThreads)
+			: new FTiledRgbaInputFile(ImagePath, NumThreads));
+	}
+
+	OutHeaderTime = FPlatformTime::Seconds() - StartTime;
+
+	// the image file may no longer be tiled, or have as many levels, as when the sequence was indexed
+	if (!InputFile->IsValid() || (Level >= InputFile->GetNumLevels()))
+	{
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ExrMedia_ReadPixels);
+	EXRMEDIA_TRACE_SCOPE("Read Pixels", Frame.FrameIndex);
+
+	Frame.Dim = InputFile->GetDataWindow(Level);
+	Frame.Data.AddUninitialized(Frame.Dim.X * Frame.Dim.Y * 4 * sizeof(uint16));
+
+	return InputFile->SetFrameBuffer(Frame.Data.GetData(), Frame.Dim, Level) && InputFile->ReadLevel(Level);
+}
+
+
+bool FExrMediaLoaderWork::ReadRows(FExrMediaFrame& Frame, const FExrMappedFile* MappedFile, int32 InNumThreads, int32 StartY, int32 EndY, double& OutHeaderTime) const
+{
+	if (DecodeOptions.DirectChannels || (DecodeOptions.ChannelNames.Num() > 0))
+	{
+		return ExrMediaReadRows<FChannelInputFile>(ImagePath, MappedFile, DecodeOptions.Part, InNumThreads, DecodeOptions.ChannelNames, Frame, StartY, EndY, OutHeaderTime);
+	}
+
+	return ExrMediaReadRows<FRgbaInputFile>(ImagePath, MappedFile, DecodeOptions.Part, InNumThreads, DecodeOptions.ChannelNames, Frame, StartY, EndY, OutHeaderTime);
+}
+
+
+bool FExrMediaLoaderWork::ReadStripes(FExrMediaFrame& Frame, const FExrMappedFile* MappedFile, double& OutHeaderTime) const
+{
+	const int32 LinesPerBlock = FMath::Max(1, FrameInfo.LinesPerBlock);
+	const int32 NumBlocks = FMath::DivideAndRoundUp(Frame.Dim.Y, LinesPerBlock);
+	const int32 BlocksPerStripe = FMath::DivideAndRoundUp(NumBlocks, NumStripes);
+	const int32 LinesPerStripe = BlocksPerStripe * LinesPerBlock;
+	const int32 NumUsedStripes = FMath::DivideAndRoundUp(Frame.Dim.Y, LinesPerStripe);
+
+	FThreadSafeCounter NumFailedStripes;
+
+	ParallelFor(NumUsedStripes, [&](int32 StripeIndex)
+	{
+		const int32 StartY = StripeIndex * LinesPerStripe;
+		const int32 EndY = FMath::Min(StartY + LinesPerStripe, Frame.Dim.Y) - 1;
+
+		// all stripes share the frame buffer, but write disjoint rows;
+		// their headers are parsed in parallel, so one stripe's time is reported
+		double StripeHeaderTime = 0.0;
+
+		if (!ReadRows(Frame, MappedFile, 0, StartY, EndY, StripeHeaderTime))
+		{
+			NumFailedStripes.Increment();
+		}
+
+		if (StripeIndex == 0)
+		{
+			OutHeaderTime = StripeHeaderTime;
+		}
+	});
+
+	return (NumFailedStripes.GetValue() == 0);
+}
+
+
+bool FExrMediaLoaderWork::ReadSubsampled(FExrMediaFrame& Frame, const FExrMappedFile* MappedFile, double& OutHeaderTime) const
+{
+	if (DecodeOptions.DirectChannels)
+	{
+		return ExrMediaReadSubsampled<FChannelInputFile>(ImagePath, MappedFile, NumThreads, FrameInfo, DecodeOptions.SubsampleFactor, Frame, OutHeaderTime);
+	}
+
+	return ExrMediaReadSubsampled<FRgbaInputFile>(ImagePath, MappedFile, NumThreads, FrameInfo, DecodeOptions.SubsampleFactor, Frame, OutHeaderTime);
+}
+
+
+void FExrMediaLoaderWork::ConvertFrame(FExrMediaFrame& Frame, int32 NumChannels) const
+{
+	if (DecodeOptions.OutputFormat == EMediaTextureSinkFormat::FloatRGBA)
+	{
+		// single channel pixels are shown as opaque gray, like in the other output formats
+		if (NumChannels == 1)
+		{
+			SCOPE_CYCLE_COUNTER(STAT_ExrMedia_ConvertFrame);
+			EXRMEDIA_TRACE_SCOPE("Convert Frame", Frame.FrameIndex);
+
+			const int32 NumPixels = Frame.Dim.X * Frame.Dim.Y;
+			const uint16* Source = (const uint16*)Frame.Data.GetData();
+
+			TArray<uint8> Pixels;
+			Pixels.AddUninitialized(NumPixels * 4 * sizeof(uint16));
+
+			uint16* Dest = (uint16*)Pixels.GetData();
+
+			for (int32 PixelIndex = 0; PixelIndex < NumPixels; ++PixelIndex)
+			{
+				Dest[0] = Dest[1] = Dest[2] = Source[PixelIndex];
+				Dest[3] = 0x3c00; // 1.0 in half precision
+				Dest += 4;
+			}
+
+			Frame.Data = MoveTemp(Pixels);
+		}
+
+		Frame.Format = EMediaTextureSinkFormat::FloatRGBA;
+		Frame.Stride = Frame.Dim.X * 4 * sizeof(uint16);
+
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ExrMedia_ConvertFrame);
+	EXRMEDIA_TRACE_SCOPE("Convert Frame", Frame.FrameIndex);
+
+	const int32 RowsPerChunk = 64;
+	const int32 NumChunks = FMath::DivideAndRoundUp(Frame.Dim.Y, RowsPerChunk);
+	const int32 NumPixels = Frame.Dim.X * Frame.Dim.Y;
+	const uint16* Source = (const uint16*)Frame.Data.GetData();
+
+	// both output formats are four bytes per pixel
+	TArray<uint8> Pixels;
+	Pixels.AddUninitialized(NumPixels * 4);
+
+	// like decoding, only frames that are needed immediately are converted in parallel,
+	// whether they were decoded in stripes or with OpenEXR's own threads
+	ParallelFor(NumChunks, [&](int32 ChunkIndex)
+	{
+		const int32 StartPixel = ChunkIndex * RowsPerChunk * Frame.Dim.X;
+		const int32 NumChunkPixels = FMath::Min(RowsPerChunk * Frame.Dim.X, NumPixels - StartPixel);
+
+		// rows are stored without padding, so a chunk is converted as one long row
+		if (DecodeOptions.OutputFormat == EMediaTextureSinkFormat::CharBGRA)
+		{
+			ExrMedia::ToneMapRow(Source + StartPixel * NumChannels, NumChannels, NumChunkPixels, DecodeOptions.ExposureScale, Pixels.GetData() + StartPixel * 4);
+		}
+		else
+		{
+			ExrMedia::PackRowFloatRGB(Source + StartPixel * NumChannels, NumChannels, NumChunkPixels, (uint32*)Pixels.GetData() + StartPixel);
+		}
+	}, (NumStripes <= 1) && (NumThreads == 0));
+
+	Frame.Data = MoveTemp(Pixels);
+	Frame.Format = DecodeOptions.OutputFormat;
+	Frame.Stride = Frame.Dim.X * 4;
+}
@@ -0,0 +1,173 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/UnrealString.h"
+#include "ExrMediaDecodeOptions.h"
+#include "ExrMediaSequenceIndex.h"
+#include "Misc/IQueuedWork.h"
+#include "Templates/SharedPointer.h"
+
+class FExrMappedFile;
+class FExrMediaLoader;
+struct FExrMediaDecodeTimings;
+struct FExrMediaFrame;
+
+
+/**
+ * Decodes a single EXR image sequence frame on a decoder thread.
+ *
+ * Work items delete themselves when they are done or abandoned.
+ */
+class FExrMediaLoaderWork
+	: public IQueuedWork
+{
+public:
+
+	/**
+	 * Create and initialize a new instance.
+	 *
+	 * @param InOwner The loader that created this work item.
+	 * @param InFrameIndex Index of the frame to decode.
+	 * @param InImagePath Path to the frame's EXR image file.
+	 * @param InFrameInfo The frame's header information from the sequence index.
+	 * @param InContainer Memory mapping of the sequence container file, or nullptr if the sequence is not packed.
+	 * @param InDecodeOptions Options that control how the frame is decoded.
+	 * @param InGeneration The loader's decode options generation.
+	 * @param InNumThreads Number of OpenEXR threads to decompress the frame with (0 = decode on the calling thread).
+	 * @param InNumStripes Number of horizontal stripes to decode in parallel, each with its own input file (1 = not striped).
+	 * @param InPreview Whether to decode a low resolution preview before the frame itself.
+	 */
+	FExrMediaLoaderWork(FExrMediaLoader& InOwner, int32 InFrameIndex, const FString& InImagePath, const FExrMediaFrameInfo& InFrameInfo, const FExrMappedFile* InContainer, const FExrMediaDecodeOptions& InDecodeOptions, int32 InGeneration, int32 InNumThreads, int32 InNumStripes, bool InPreview);
+
+public:
+
+	//~ IQueuedWork interface
+
+	virtual void Abandon() override;
+	virtual void DoThreadedWork() override;
+
+protected:
+
+	/**
+	 * Convert a decoded frame of half-float pixels to the output format.
+	 *
+	 * Frames for 8-bit output are tone mapped to sRGB BGRA, and frames for
+	 * FloatRGB output are packed into 32-bit floating point RGB. Either way,
+	 * the pixels are replaced with a buffer of four bytes per pixel.
+	 *
+	 * @param Frame The decoded frame to convert.
+	 * @param NumChannels Number of half-float channels per decoded pixel (1, 3 or 4).
+	 */
+	void ConvertFrame(FExrMediaFrame& Frame, int32 NumChannels) const;
+
+	/**
+	 * Decode and convert the frame with the current decode options.
+	 *
+	 * @param MappedFile The memory mapped image file, or nullptr to read the file by path.
+	 * @param InOutTimings Will contain the header, decompress and convert times.
+	 * @return The decoded frame, or nullptr if decoding failed.
+	 */
+	TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> DecodeFrame(const FExrMappedFile* MappedFile, FExrMediaDecodeTimings& InOutTimings) const;
+
+	/**
+	 * Decode a low resolution preview of the frame and hand it to the owner.
+	 *
+	 * Previews are read from a reduced mip level of tiled images, or subsampled from
+	 * images with one scan line per block. Other images are not previewed, because
+	 * all of their line blocks would have to be decompressed anyway.
+	 *
+	 * @param MappedFile The memory mapped image file, or nullptr to read the file by path.
+	 */
+	void DecodePreview(const FExrMappedFile* MappedFile);
+
+	/**
+	 * Decode a reduced resolution mip level of a tiled frame.
+	 *
+	 * @param Frame The frame to decode into (its dimensions and buffer will be set).
+	 * @param MappedFile The memory mapped image file, or nullptr to read the file by path.
+	 * @param Level The mip level to decode.
+	 * @param OutHeaderTime Will contain the time spent parsing the image header (in seconds).
+	 * @return true on success, false if the image file could not be decoded.
+	 */
+	bool ReadMipLevel(FExrMediaFrame& Frame, const FExrMappedFile* MappedFile, int32 Level, double& OutHeaderTime) const;
+
+	/**
+	 * Decode a range of rows of the frame.
+	 *
+	 * Sequences with half-float RGB(A) channels only, and sequences decoded
+	 * into narrower pixels, are decoded through a channel input file whose
+	 * slices point straight into the frame buffer; all others go through
+	 * OpenEXR's RGBA conversion layer.
+	 *
+	 * @param Frame The frame to decode into (must have its dimensions and buffer set).
+	 * @param MappedFile The memory mapped image file, or nullptr to read the file by path.
+	 * @param InNumThreads Number of OpenEXR threads to decompress the rows with.
+	 * @param StartY Index of the first row to decode.
+	 * @param EndY Index of the last row to decode.
+	 * @param OutHeaderTime Will contain the time spent parsing the image header (in seconds).
+	 * @return true on success, false if the image file does not match the frame.
+	 */
+	bool ReadRows(FExrMediaFrame& Frame, const FExrMappedFile* MappedFile, int32 InNumThreads, int32 StartY, int32 EndY, double& OutHeaderTime) const;
+
+	/**
+	 * Decode the frame in horizontal stripes.
+	 *
+	 * Each stripe is decoded on its own task with its own input file, directly
+	 * into a disjoint range of rows of the frame buffer. Stripe boundaries are
+	 * aligned to the file's line blocks, so that no block is decompressed twice.
+	 *
+	 * @param Frame The frame to decode into (must have its dimensions and buffer set).
+	 * @param MappedFile The memory mapped image file shared by all stripes, or nullptr to read the file by path.
+	 * @param OutHeaderTime Will contain the time spent parsing the image header of the first stripe (in seconds).
+	 * @return true on success, false if any stripe failed to decode.
+	 */
+	bool ReadStripes(FExrMediaFrame& Frame, const FExrMappedFile* MappedFile, double& OutHeaderTime) const;
+
+	/**
+	 * Decode the frame at a reduced resolution.
+	 *
+	 * Each output row is box filtered from up to SubsampleFactor source rows, but
+	 * never from rows of more than one line block. In images with one scan line
+	 * per block, only every SubsampleFactor-th line block is decompressed.
+	 *
+	 * @param Frame The frame to decode into (must have its reduced dimensions and buffer set).
+	 * @param MappedFile The memory mapped image file, or nullptr to read the file by path.
+	 * @param OutHeaderTime Will contain the time spent parsing the image header (in seconds).
+	 * @return true on success, false if the image file does not match the frame.
+	 */
+	bool ReadSubsampled(FExrMediaFrame& Frame, const FExrMappedFile* MappedFile, double& OutHeaderTime) const;
+
+private:
+
+	/** Memory mapping of the sequence container file, or nullptr if the sequence is not packed. */
+	const FExrMappedFile* Container;
+
+	/** Options that control how the frame is decoded. */
+	FExrMediaDecodeOptions DecodeOptions;
+
+	/** Index of the frame to decode. */
+	int32 FrameIndex;
+
+	/** The frame's header information from the sequence index. */
+	FExrMediaFrameInfo FrameInfo;
+
+	/** The loader's decode options generation. */
+	int32 Generation;
+
+	/** Path to the frame's EXR image file. */
+	FString ImagePath;
+
+	/** Number of horizontal stripes to decode in parallel. */
+	int32 NumStripes;
+
+	/** Number of OpenEXR threads to decompress the frame with. */
+	int32 NumThreads;
+
+	/** The loader that created this work item. */
+	FExrMediaLoader& Owner;
+
+	/** Whether to decode a low resolution preview before the frame itself. */
+	bool Preview;
+};
@@ -0,0 +1,83 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "ExrMediaPackFloat.h"
+#include "ExrMediaPrivate.h"
+
+#include "ExrMediaSimd.h"
+#include "Math/UnrealMathUtility.h"
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/** Number of pixels that are converted at a time. */
+static const int32 ExrMediaPackChunkSize = 64;
+
+
+/**
+ * Round consecutive half-floats to unsigned 11-bit and 10-bit floats.
+ *
+ * Negative values (and negative NaNs) become zero; positive infinities and
+ * NaNs become the largest finite value.
+ */
+static void ExrMediaRoundHalves(const uint16* Source, int32 NumValues, uint16* Dest11, uint16* Dest10)
+{
+	int32 ValueIndex = 0;
+
+#if EXRMEDIA_SSE2
+	// eight values per iteration; the rounding carry may ripple into the exponent, which is intended
+	const __m128i Max11 = _mm_set1_epi16(0x7bf);
+	const __m128i Max10 = _mm_set1_epi16(0x3df);
+
+	for (; ValueIndex + 8 <= NumValues; ValueIndex += 8)
+	{
+		__m128i Halves = _mm_loadu_si128((const __m128i*)(Source + ValueIndex));
+		Halves = _mm_andnot_si128(_mm_srai_epi16(Halves, 15), Halves);
+
+		// the saturating add keeps large values from wrapping around
+		const __m128i Rounded11 = _mm_min_epi16(_mm_srli_epi16(_mm_adds_epu16(Halves, _mm_set1_epi16(0x8)), 4), Max11);
+		const __m128i Rounded10 = _mm_min_epi16(_mm_srli_epi16(_mm_adds_epu16(Halves, _mm_set1_epi16(0x10)), 5), Max10);
+
+		_mm_storeu_si128((__m128i*)(Dest11 + ValueIndex), Rounded11);
+		_mm_storeu_si128((__m128i*)(Dest10 + ValueIndex), Rounded10);
+	}
+#endif
+
+	for (; ValueIndex < NumValues; ++ValueIndex)
+	{
+		const uint32 Half = ((Source[ValueIndex] & 0x8000) != 0) ? 0 : Source[ValueIndex];
+
+		Dest11[ValueIndex] = (uint16)FMath::Min<uint32>((Half + 0x8) >> 4, 0x7bf);
+		Dest10[ValueIndex] = (uint16)FMath::Min<uint32>((Half + 0x10) >> 5, 0x3df);
+	}
+}
+
+
+/* ExrMedia functions
+ *****************************************************************************/
+
+void ExrMedia::PackRowFloatRGB(const uint16* Source, int32 NumChannels, int32 NumPixels, uint32* Dest)
+{
+	const int32 GreenOffset = (NumChannels > 1) ? 1 : 0;
+	const int32 BlueOffset = (NumChannels > 1) ? 2 : 0;
+
+	uint16 Values11[ExrMediaPackChunkSize * 4];
+	uint16 Values10[ExrMediaPackChunkSize * 4];
+
+	for (int32 ChunkStart = 0; ChunkStart < NumPixels; ChunkStart += ExrMediaPackChunkSize)
+	{
+		const int32 ChunkSize = FMath::Min(ExrMediaPackChunkSize, NumPixels - ChunkStart);
+
+		// rounding is vectorized across channels, the packing is not
+		ExrMediaRoundHalves(Source + ChunkStart * NumChannels, ChunkSize * NumChannels, Values11, Values10);
+
+		for (int32 PixelIndex = 0; PixelIndex < ChunkSize; ++PixelIndex)
+		{
+			const int32 ValueIndex = PixelIndex * NumChannels;
+
+			Dest[ChunkStart + PixelIndex] = (uint32)Values11[ValueIndex]
+				| ((uint32)Values11[ValueIndex + GreenOffset] << 11)
+				| ((uint32)Values10[ValueIndex + BlueOffset] << 22);
+		}
+	}
+}
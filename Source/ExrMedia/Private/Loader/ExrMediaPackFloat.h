@@ -0,0 +1,26 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+
+
+namespace ExrMedia
+{
+	/**
+	 * Convert a row of half-float pixels to packed 32-bit floating point RGB pixels.
+	 *
+	 * The output holds an unsigned 11-bit float for red and green and an unsigned
+	 * 10-bit float for blue (the layout of PF_FloatRGB). These share the exponent
+	 * bias of half-floats, so the conversion only rounds off mantissa bits. Negative
+	 * values become zero, and values beyond the largest representable one are clamped.
+	 * Single channel pixels are converted to gray. Uses SSE2 where available and falls
+	 * back to scalar code elsewhere.
+	 *
+	 * @param Source The source pixels.
+	 * @param NumChannels Number of channels per source pixel (1 = Y, 3 = RGB, 4 = RGBA).
+	 * @param NumPixels Number of pixels to convert.
+	 * @param Dest Will contain the converted pixels.
+	 */
+	void PackRowFloatRGB(const uint16* Source, int32 NumChannels, int32 NumPixels, uint32* Dest);
+}
@@ -0,0 +1,66 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+
+
+/** Whether the SIMD kernels use SSE2 (all x64 and most x86 targets). */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define EXRMEDIA_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define EXRMEDIA_SSE2 0
+#endif
+
+
+#if EXRMEDIA_SSE2
+
+/* SSE2 helpers
+ *****************************************************************************/
+
+/**
+ * Convert four half-floats (in the lower 16 bits of each lane) to single precision.
+ *
+ * Denormals are handled by a multiplication with 2^112; infinities and NaNs keep
+ * their maximum exponent.
+ */
+FORCEINLINE __m128 ExrMediaHalfToFloat(__m128i Half)
+{
+	const __m128i ExpMant = _mm_and_si128(Half, _mm_set1_epi32(0x7fff));
+	const __m128i Sign = _mm_slli_epi32(_mm_xor_si128(Half, ExpMant), 16);
+	const __m128 Scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(ExpMant, 13)), _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+	const __m128i WasInfNan = _mm_cmpgt_epi32(ExpMant, _mm_set1_epi32(0x7bff));
+	const __m128 InfNanExp = _mm_and_ps(_mm_castsi128_ps(WasInfNan), _mm_castsi128_ps(_mm_set1_epi32(255 << 23)));
+
+	return _mm_or_ps(Scaled, _mm_or_ps(_mm_castsi128_ps(Sign), InfNanExp));
+}
+
+
+/**
+ * Convert four single precision floats to half-floats (in the lower 16 bits of each lane).
+ *
+ * Values that are too large for half-floats become infinities, NaNs stay NaNs.
+ */
+FORCEINLINE __m128i ExrMediaFloatToHalf(__m128 Float)
+{
+	const __m128 MaskRound = _mm_castsi128_ps(_mm_set1_epi32(~0xfff));
+	const __m128i F32Infinity = _mm_set1_epi32(255 << 23);
+
+	const __m128 JustSign = _mm_and_ps(Float, _mm_castsi128_ps(_mm_set1_epi32(0x80000000)));
+	const __m128 AbsFloat = _mm_xor_ps(Float, JustSign);
+	const __m128i AbsInt = _mm_castps_si128(AbsFloat);
+
+	const __m128i IsNan = _mm_cmpgt_epi32(AbsInt, F32Infinity);
+	const __m128i IsNormal = _mm_cmpgt_epi32(F32Infinity, AbsInt);
+	const __m128i InfOrNan = _mm_or_si128(_mm_and_si128(IsNan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+
+	const __m128 Scaled = _mm_mul_ps(_mm_and_ps(AbsFloat, MaskRound), _mm_castsi128_ps(_mm_set1_epi32(15 << 23)));
+	const __m128 Clamped = _mm_min_ps(Scaled, _mm_castsi128_ps(_mm_set1_epi32((31 << 23) - 0x1000)));
+	const __m128i Shifted = _mm_srli_epi32(_mm_sub_epi32(_mm_castps_si128(Clamped), _mm_castps_si128(MaskRound)), 13);
+	const __m128i Joined = _mm_or_si128(_mm_and_si128(Shifted, IsNormal), _mm_andnot_si128(IsNormal, InfOrNan));
+
+	return _mm_or_si128(Joined, _mm_srli_epi32(_mm_castps_si128(JustSign), 16));
+}
+
+#endif
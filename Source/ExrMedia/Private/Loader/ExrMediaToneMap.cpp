@@ -0,0 +1,131 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "ExrMediaToneMap.h"
+#include "ExrMediaPrivate.h"
+
+#include "ExrMediaSimd.h"
+#include "Math/Float16.h"
+#include "Math/UnrealMathUtility.h"
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/** Number of pixels that are quantized at a time. */
+static const int32 ExrMediaToneMapChunkSize = 64;
+
+/** Number of entries in the sRGB encoding table (14 bits of linear precision). */
+static const int32 ExrMediaSrgbTableSize = 1 << 14;
+
+
+/**
+ * Lookup table that maps quantized linear values to 8-bit sRGB values.
+ *
+ * The dark end of the sRGB curve is steep, so the table is indexed with more
+ * bits than it outputs, which keeps the error at about half a code value.
+ */
+struct FExrMediaSrgbTable
+{
+	uint8 Values[ExrMediaSrgbTableSize];
+
+	FExrMediaSrgbTable()
+	{
+		for (int32 Index = 0; Index < ExrMediaSrgbTableSize; ++Index)
+		{
+			const float Linear = Index / (float)(ExrMediaSrgbTableSize - 1);
+			const float Srgb = (Linear <= 0.0031308f) ? (Linear * 12.92f) : (1.055f * FMath::Pow(Linear, 1.0f / 2.4f) - 0.055f);
+
+			Values[Index] = (uint8)FMath::Clamp(FMath::RoundToInt(Srgb * 255.0f), 0, 255);
+		}
+	}
+};
+
+
+/** The sRGB encoding table, built when the module is loaded. */
+static const FExrMediaSrgbTable ExrMediaSrgbTable;
+
+
+/** Clamp a value to [0, 1], turning NaNs into zero. */
+static FORCEINLINE float ExrMediaSaturate(float Value)
+{
+	return (Value > 0.0f) ? FMath::Min(Value, 1.0f) : 0.0f;
+}
+
+
+/**
+ * Quantize consecutive half-float values.
+ *
+ * Color values are scaled to sRGB table indices. If the pixels have an alpha
+ * channel, every fourth value is alpha, which is scaled to its 8-bit output.
+ */
+static void ExrMediaQuantize(const uint16* Source, int32 NumValues, bool HasAlpha, float ExposureScale, uint16* Dest)
+{
+	const float MaxIndex = (float)(ExrMediaSrgbTableSize - 1);
+	int32 ValueIndex = 0;
+
+#if EXRMEDIA_SSE2
+	// eight values per iteration, in two vectors that line up with RGBA pixels
+	const __m128i Zero = _mm_setzero_si128();
+	const __m128 One = _mm_set1_ps(1.0f);
+	const __m128 Exposure = _mm_setr_ps(ExposureScale, ExposureScale, ExposureScale, HasAlpha ? 1.0f : ExposureScale);
+	const __m128 Quantize = _mm_setr_ps(MaxIndex, MaxIndex, MaxIndex, HasAlpha ? 255.0f : MaxIndex);
+
+	for (; ValueIndex + 8 <= NumValues; ValueIndex += 8)
+	{
+		const __m128i Halves = _mm_loadu_si128((const __m128i*)(Source + ValueIndex));
+
+		__m128 First = _mm_mul_ps(ExrMediaHalfToFloat(_mm_unpacklo_epi16(Halves, Zero)), Exposure);
+		__m128 Second = _mm_mul_ps(ExrMediaHalfToFloat(_mm_unpackhi_epi16(Halves, Zero)), Exposure);
+
+		// the maximum with zero comes first, so that NaNs turn into zero
+		First = _mm_min_ps(_mm_max_ps(First, _mm_setzero_ps()), One);
+		Second = _mm_min_ps(_mm_max_ps(Second, _mm_setzero_ps()), One);
+
+		const __m128i Packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(First, Quantize)), _mm_cvtps_epi32(_mm_mul_ps(Second, Quantize)));
+		_mm_storeu_si128((__m128i*)(Dest + ValueIndex), Packed);
+	}
+#endif
+
+	const FFloat16* Values = (const FFloat16*)Source;
+
+	for (; ValueIndex < NumValues; ++ValueIndex)
+	{
+		const bool IsAlpha = HasAlpha && ((ValueIndex & 3) == 3);
+
+		Dest[ValueIndex] = IsAlpha
+			? (uint16)FMath::RoundToInt(ExrMediaSaturate((float)Values[ValueIndex]) * 255.0f)
+			: (uint16)FMath::RoundToInt(ExrMediaSaturate((float)Values[ValueIndex] * ExposureScale) * MaxIndex);
+	}
+}
+
+
+/* ExrMedia functions
+ *****************************************************************************/
+
+void ExrMedia::ToneMapRow(const uint16* Source, int32 NumChannels, int32 NumPixels, float ExposureScale, uint8* Dest)
+{
+	const bool HasAlpha = (NumChannels == 4);
+	const int32 GreenOffset = (NumChannels > 1) ? 1 : 0;
+	const int32 BlueOffset = (NumChannels > 1) ? 2 : 0;
+
+	uint16 Indices[ExrMediaToneMapChunkSize * 4];
+
+	for (int32 ChunkStart = 0; ChunkStart < NumPixels; ChunkStart += ExrMediaToneMapChunkSize)
+	{
+		const int32 ChunkSize = FMath::Min(ExrMediaToneMapChunkSize, NumPixels - ChunkStart);
+
+		// quantization is vectorized across channels, the table lookups are not
+		ExrMediaQuantize(Source + ChunkStart * NumChannels, ChunkSize * NumChannels, HasAlpha, ExposureScale, Indices);
+
+		const uint16* Index = Indices;
+		uint8* Pixel = Dest + ChunkStart * 4;
+
+		for (int32 PixelIndex = 0; PixelIndex < ChunkSize; ++PixelIndex, Index += NumChannels, Pixel += 4)
+		{
+			Pixel[0] = ExrMediaSrgbTable.Values[Index[BlueOffset]];
+			Pixel[1] = ExrMediaSrgbTable.Values[Index[GreenOffset]];
+			Pixel[2] = ExrMediaSrgbTable.Values[Index[0]];
+			Pixel[3] = HasAlpha ? (uint8)Index[3] : 255;
+		}
+	}
+}
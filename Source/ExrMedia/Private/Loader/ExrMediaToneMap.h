@@ -0,0 +1,26 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+
+
+namespace ExrMedia
+{
+	/**
+	 * Convert a row of half-float pixels to 8-bit sRGB BGRA pixels.
+	 *
+	 * The color channels are multiplied by the exposure scale, clamped to [0, 1] and
+	 * encoded with the sRGB transfer function through a lookup table. Alpha is clamped
+	 * and quantized linearly, or set to opaque if the source has no alpha channel.
+	 * Single channel pixels are converted to gray. Uses SSE2 where available and falls
+	 * back to scalar code elsewhere.
+	 *
+	 * @param Source The source pixels.
+	 * @param NumChannels Number of channels per source pixel (1 = Y, 3 = RGB, 4 = RGBA).
+	 * @param NumPixels Number of pixels to convert.
+	 * @param ExposureScale Linear factor that the color channels are multiplied with.
+	 * @param Dest Will contain the converted pixels.
+	 */
+	void ToneMapRow(const uint16* Source, int32 NumChannels, int32 NumPixels, float ExposureScale, uint8* Dest);
+}
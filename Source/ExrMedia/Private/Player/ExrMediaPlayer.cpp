@@ -3,27 +3,63 @@
 #include "ExrMediaPlayer.h"
 #include "ExrMediaPrivate.h"
 
-#include "HAL/FileManager.h"
+#include "Async/Async.h"
+#include "ExrMediaDecodeScheduler.h"
+#include "ExrMediaLoader.h"
+#include "ExrMediaQualityGovernor.h"
+#include "ExrMediaSequenceIndex.h"
+#include "ExrMediaSource.h"
+#include "ExrMediaTrace.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformTime.h"
 #include "IMediaOptions.h"
 #include "IMediaTextureSink.h"
-#include "Misc/Paths.h"
 #include "Misc/ScopeLock.h"
-#include "OpenExrWrapper.h"
+#include "UObject/Class.h"
 
 
 #define LOCTEXT_NAMESPACE "FExrMediaPlayer"
 
 
+DECLARE_CYCLE_STAT(TEXT("Open Sequence"), STAT_ExrMedia_OpenSequence, STATGROUP_ExrMedia);
+DECLARE_CYCLE_STAT(TEXT("Tick Video"), STAT_ExrMedia_TickVideo, STATGROUP_ExrMedia);
+DECLARE_CYCLE_STAT(TEXT("Display Frame"), STAT_ExrMedia_DisplayFrame, STATGROUP_ExrMedia);
+DECLARE_CYCLE_STAT(TEXT("Acquire Sink Buffer"), STAT_ExrMedia_AcquireSinkBuffer, STATGROUP_ExrMedia);
+DECLARE_CYCLE_STAT(TEXT("Release Sink Buffer"), STAT_ExrMedia_ReleaseSinkBuffer, STATGROUP_ExrMedia);
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/** Pad a layer's channel names with channels that are not in the image, which OpenEXR fills with 0 (1 for alpha). */
+static void ExrMediaPadChannelNames(const FExrMediaLayer& Layer, int32 NumChannels, TArray<FString>& InOutChannelNames)
+{
+	const FString Prefix = Layer.Prefix.IsEmpty() ? FString() : (Layer.Prefix + TEXT("."));
+
+	while (InOutChannelNames.Num() < NumChannels)
+	{
+		InOutChannelNames.Add(FString::Printf(TEXT("%sExrMediaFill%i"), *Prefix, InOutChannelNames.Num()));
+	}
+}
+
+
 /* FExrVideoPlayer structors
  *****************************************************************************/
 
-FExrMediaPlayer::FExrMediaPlayer()
+FExrMediaPlayer::FExrMediaPlayer(const TSharedRef<FExrMediaDecodeScheduler, ESPMode::ThreadSafe>& InScheduler)
 	: CurrentDim(FIntPoint::ZeroValue)
 	, CurrentFps(0.0)
+	, CurrentRate(0.0f)
 	, CurrentTime(0.0f)
 	, Duration(0.0f)
+	, FrameStep(1)
 	, LastFrameIndex(INDEX_NONE)
+	, LastLateFrameIndex(INDEX_NONE)
+	, ProxyLevel(0)
+	, Scheduler(InScheduler)
+	, SeekStartTime(0.0)
 	, SelectedVideoTrack(INDEX_NONE)
+	, ShouldLoop(false)
 	, VideoSink(nullptr)
 { }
 
@@ -31,6 +67,12 @@ FExrMediaPlayer::FExrMediaPlayer()
 FExrMediaPlayer::~FExrMediaPlayer()
 {
 	Close();
+
+	// a cancelled scan stops at the next file, so this does not block for long
+	if (OpenFuture.IsValid())
+	{
+		OpenFuture.Wait();
+	}
 }
 
 
@@ -61,12 +103,22 @@ EMediaState FExrMediaPlayer::GetState() const
 		return EMediaState::Closed;
 	}
 
+	if (PendingOpen.IsValid())
+	{
+		return EMediaState::Preparing;
+	}
+
 	return (CurrentRate == 0.0f) ? EMediaState::Paused : EMediaState::Playing;
 }
 
 
 TRange<float> FExrMediaPlayer::GetSupportedRates(EMediaPlaybackDirections Direction, bool Unthinned) const
 {
+	if (Direction == EMediaPlaybackDirections::Reverse)
+	{
+		return TRange<float>(-100000.0f, 0.0f);
+	}
+
 	return TRange<float>(0.0f, 100000.0f);
 }
 
@@ -90,8 +142,29 @@ bool FExrMediaPlayer::Seek(const FTimespan& Time)
 		return false;
 	}
 
+	FScopeLock Lock(&CriticalSection);
+
 	CurrentTime = Time.GetTotalSeconds();
 
+	// frames skipped by a seek do not count as dropped
+	LastFrameIndex = INDEX_NONE;
+	LastLateFrameIndex = INDEX_NONE;
+
+	// decode the target frame first, instead of waiting for stale prefetches
+	if (Loader.IsValid())
+	{
+		int32 FrameIndex = FMath::Clamp((int32)(CurrentTime * CurrentFps), 0, Loader->GetNumFrames() - 1);
+
+		if (FrameStep > 1)
+		{
+			FrameIndex -= FrameIndex % FrameStep;
+		}
+
+		// previews are read from mip levels or subsampled RGBA, which other layers do not have
+		Loader->Seek(FrameIndex, GetDefault<UExrMediaSettings>()->SeekPreviews && SequenceIndex->GetLayers()[SelectedVideoTrack].IsDefault());
+		SeekStartTime = FPlatformTime::Seconds();
+	}
+
 	return true;
 }
 
@@ -113,6 +186,18 @@ bool FExrMediaPlayer::SetRate(float Rate)
 
 	CurrentRate = Rate;
 
+	// pausing keeps the frames around the play head in the prefetch window
+	if (Rate != 0.0f)
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		if (Loader.IsValid())
+		{
+			Loader->SetDirection((Rate < 0.0f) ? -1 : 1);
+			Loader->SetFrameRate(CurrentFps * FMath::Abs(Rate));
+		}
+	}
+
 	return true;
 }
 
@@ -140,6 +225,13 @@ bool FExrMediaPlayer::SupportsSeeking() const
 
 void FExrMediaPlayer::Close()
 {
+	// the worker of a pending open only touches the shared pending state
+	if (PendingOpen.IsValid())
+	{
+		PendingOpen->Cancelled = true;
+		PendingOpen.Reset();
+	}
+
 	{
 		FScopeLock Lock(&CriticalSection);
 
@@ -148,10 +240,17 @@ void FExrMediaPlayer::Close()
 		CurrentTime = 0.0f;
 		CurrentUrl.Empty();
 		Duration = 0.0f;
-		ImagePaths.Empty();
+		FrameStep = 1;
+		Governor.Reset();
 		Info.Empty();
 		LastFrameIndex = INDEX_NONE;
+		LastLateFrameIndex = INDEX_NONE;
+		Loader.Reset();
+		OutputBuffers.Empty();
+		SeekStartTime = 0.0;
 		SelectedVideoTrack = INDEX_NONE;
+		SequenceIndex.Reset();
+		Stats.Reset();
 	}
 
 	MediaEvent.Broadcast(EMediaEvent::TracksChanged);
@@ -186,10 +285,50 @@ IMediaOutput& FExrMediaPlayer::GetOutput()
 
 FString FExrMediaPlayer::GetStats() const
 {
-	FString StatsString;
+	FString StatsString = Stats.ToString();
+
+	if (Loader.IsValid())
+	{
+		int32 NumQueued, NumReady, WindowSize;
+
+		Loader->GetPrefetchStats(NumQueued, NumReady, WindowSize);
+
+		StatsString += TEXT("Prefetch\n");
+		StatsString += FString::Printf(TEXT("    Ready: %i / %i\n"), NumReady, WindowSize);
+		StatsString += FString::Printf(TEXT("    Decoding: %i / %i\n"), NumQueued, Loader->GetNumWorkers());
+
+		int32 NumFrames;
+		SIZE_T Size, Budget;
+		uint64 NumHits, NumMisses, NumEvictions;
+
+		Loader->GetCacheStats(NumFrames, Size, Budget, NumHits, NumMisses, NumEvictions);
+
+		StatsString += TEXT("Frame Cache\n");
+		StatsString += FString::Printf(TEXT("    Frames: %i\n"), NumFrames);
+		StatsString += FString::Printf(TEXT("    Size: %.1f / %.1f MB\n"), Size / (1024.0 * 1024.0), Budget / (1024.0 * 1024.0));
+		StatsString += FString::Printf(TEXT("    Hits: %llu\n"), NumHits);
+		StatsString += FString::Printf(TEXT("    Misses: %llu\n"), NumMisses);
+		StatsString += FString::Printf(TEXT("    Evictions: %llu\n"), NumEvictions);
+	}
+
+	int32 NumLoaders, NumSchedulerQueued, NumSchedulerRunning;
+
+	Scheduler->GetStats(NumLoaders, NumSchedulerQueued, NumSchedulerRunning);
+
+	StatsString += TEXT("Decode Scheduler\n");
+	StatsString += FString::Printf(TEXT("    Players: %i\n"), NumLoaders);
+	StatsString += FString::Printf(TEXT("    Waiting: %i\n"), NumSchedulerQueued);
+	StatsString += FString::Printf(TEXT("    Decoding: %i / %i\n"), NumSchedulerRunning, Scheduler->GetNumWorkers());
+
+	if (Governor.IsValid())
 	{
-		StatsString += TEXT("not implemented yet");
-		StatsString += TEXT("\n");
+		StatsString += TEXT("Quality Governor\n");
+		StatsString += FString::Printf(TEXT("    Level: %i of %i\n"), Governor->GetLevel(), Governor->GetNumLevels() - 1);
+		StatsString += FString::Printf(TEXT("    Proxy Level: %i\n"), Governor->GetProxyLevel());
+		StatsString += FString::Printf(TEXT("    Frame Step: %i\n"), Governor->GetFrameStep());
+		StatsString += FString::Printf(TEXT("    Decode Load: %.2f\n"), Governor->GetLoad());
+		StatsString += FString::Printf(TEXT("    Switches: %i\n"), Governor->GetNumSwitches());
+		StatsString += FString::Printf(TEXT("    Last Switch: %s\n"), *Governor->GetLastSwitch());
 	}
 
 	return StatsString;
@@ -212,145 +351,677 @@ bool FExrMediaPlayer::Open(const FString& Url, const IMediaOptions& Options)
 {
 	Close();
 
-	if (Url.IsEmpty() || !Url.StartsWith(TEXT("exr://")))
+	const bool Packed = Url.StartsWith(TEXT("exrpak://"));
+
+	if (!Packed && !Url.StartsWith(TEXT("exr://")))
 	{
 		return false;
 	}
 
-	const TCHAR* SequencePath = &Url[6];
+	// media options are only available during this call
+	TSharedRef<FPendingOpen, ESPMode::ThreadSafe> NewPendingOpen = MakeShareable(new FPendingOpen());
+	{
+		NewPendingOpen->DecoderThreads = (int32)Options.GetMediaOption(ExrMedia::DecoderThreadsOption, 0.0);
+		NewPendingOpen->Dim = FIntPoint::ZeroValue;
+		NewPendingOpen->Exposure = (float)Options.GetMediaOption(ExrMedia::ExposureOption, 0.0);
+		NewPendingOpen->FpsOverride = Options.GetMediaOption(ExrMedia::FramesPerSecondOverrideOption, 0.0f);
+		NewPendingOpen->NumOutputBuffers = (int32)Options.GetMediaOption(ExrMedia::OutputBuffersOption, 0.0);
+		NewPendingOpen->OutputFormat = (EExrMediaOutputFormat)(int32)Options.GetMediaOption(ExrMedia::OutputFormatOption, 0.0);
+		NewPendingOpen->PrefetchDepth = (int32)Options.GetMediaOption(ExrMedia::PrefetchDepthOption, 8.0);
+		NewPendingOpen->ProxyLevel = (int32)Options.GetMediaOption(ExrMedia::ProxyLevelOption, 0.0);
+		NewPendingOpen->SequencePath = Url.RightChop(Packed ? 9 : 6);
+	}
+
+	CurrentUrl = Url;
+	PendingOpen = NewPendingOpen;
 
-	// locate image sequence files
-	TArray<FString> OutImageFiles;
+	// scan the sequence and probe its headers off the game thread
+	OpenFuture = Async<void>(EAsyncExecution::ThreadPool, [NewPendingOpen, Packed]()
 	{
-		IFileManager::Get().FindFiles(OutImageFiles, SequencePath, TEXT("*.exr"));
+		SCOPE_CYCLE_COUNTER(STAT_ExrMedia_OpenSequence);
+		EXRMEDIA_TRACE_SCOPE("Open Sequence", INDEX_NONE);
+
+		FPendingOpen& Pending = NewPendingOpen.Get();
+		TSharedRef<FExrMediaSequenceIndex, ESPMode::ThreadSafe> NewSequenceIndex = MakeShareable(new FExrMediaSequenceIndex());
 
-		if (OutImageFiles.Num() == 0)
+		if (Packed)
 		{
-			UE_LOG(LogExrMedia, Error, TEXT("The directory %s does not contain any .exr image files"), SequencePath);
-			return false;
+			// load packed sequence index
+			if (!NewSequenceIndex->BuildFromContainer(Pending.SequencePath))
+			{
+				UE_LOG(LogExrMedia, Error, TEXT("Failed to load the EXR sequence container %s"), *Pending.SequencePath);
+				Pending.Completed = true;
+
+				return;
+			}
+		}
+		else if (!NewSequenceIndex->Build(Pending.SequencePath, &Pending.Cancelled))
+		{
+			// index image sequence files
+			if (!Pending.Cancelled)
+			{
+				UE_LOG(LogExrMedia, Error, TEXT("The directory %s does not contain any .exr image files"), *Pending.SequencePath);
+			}
+
+			Pending.Completed = true;
+
+			return;
 		}
 
-		UE_LOG(LogExrMedia, Verbose, TEXT("Found %i EXR image files in %s"), SequencePath);
+		if (Pending.Cancelled)
+		{
+			return;
+		}
+
+		UE_LOG(LogExrMedia, Verbose, TEXT("Found %i EXR image files in %s"), NewSequenceIndex->GetNumFrames(), *Pending.SequencePath);
+
+		// fetch sequence attributes from first image
+		if (NewSequenceIndex->GetFrameInfo(0).Dim.GetMin() <= 0)
+		{
+			UE_LOG(LogExrMedia, Error, TEXT("The image sequence does not contain a valid data window size"));
+			Pending.Completed = true;
 
-		OutImageFiles.Sort();
+			return;
+		}
+
+		if (NewSequenceIndex->GetLayers().Num() == 0)
+		{
+			UE_LOG(LogExrMedia, Error, TEXT("The image sequence does not contain any layers that can be played"));
+			Pending.Completed = true;
+
+			return;
+		}
+
+		// the first layer is played until another track is selected
+		Pending.Dim = ResolveProxyLevel(*NewSequenceIndex, 0, Pending.ProxyLevel, Pending.DecodeOptions);
+		Pending.SequenceIndex = NewSequenceIndex;
+		Pending.Completed = true;
+	});
+
+	return true;
+}
+
+
+bool FExrMediaPlayer::Open(const TSharedRef<FArchive, ESPMode::ThreadSafe>& Archive, const FString& OriginalUrl, const IMediaOptions& Options)
+{
+	return false; // not supported
+}
+
+
+void FExrMediaPlayer::TickPlayer(float DeltaTime)
+{
+	// finish opening once the sequence has been scanned
+	if (PendingOpen.IsValid() && PendingOpen->Completed)
+	{
+		FinishOpen();
 	}
 
-	// fetch sequence attributes from first image
-	FRgbaInputFile InputFile(FPaths::Combine(SequencePath, OutImageFiles[0]));
-	FIntPoint Dim = InputFile.GetDataWindow();
+	// forward events that were raised on other threads
+	EMediaEvent Event;
 
-	if (Dim.GetMin() <= 0)
+	while (DeferredEvents.Dequeue(Event))
 	{
-		UE_LOG(LogExrMedia, Error, TEXT("The image sequence does not contain a valid data window size"));
-		return false;
+		MediaEvent.Broadcast(Event);
 	}
 
-	double Fps = Options.GetMediaOption(ExrMedia::FramesPerSecondOverrideOption, 0.0f);
+	// publish statistics to the stat system
+	FScopeLock Lock(&CriticalSection);
 
-	if (Fps == 0.0f)
+	if (Loader.IsValid())
 	{
-		Fps = InputFile.GetFramesPerSecond(24.0);
+		int32 NumFrames, NumQueued, NumReady, WindowSize;
+		SIZE_T Size, Budget;
+		uint64 NumHits, NumMisses, NumEvictions;
+
+		Loader->GetCacheStats(NumFrames, Size, Budget, NumHits, NumMisses, NumEvictions);
+		Loader->GetPrefetchStats(NumQueued, NumReady, WindowSize);
+
+		Stats.PublishStats(NumFrames, NumReady);
 	}
+}
 
-	// finalize initialization
+
+void FExrMediaPlayer::TickVideo(float DeltaTime)
+{
+	if (Duration == 0.0f)
 	{
-		FScopeLock Lock(&CriticalSection);
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ExrMedia_TickVideo);
+	EXRMEDIA_TRACE_SCOPE("Tick Video", INDEX_NONE);
+
+	// update clock (wraps around at either end)
+	CurrentTime += DeltaTime * CurrentRate;
+	CurrentTime = FMath::Fmod(CurrentTime, Duration);
 
-		for (const auto& ImageFile : OutImageFiles)
+	if (CurrentTime < 0.0f)
+	{
+		CurrentTime += Duration;
+	}
+
+	FScopeLock Lock(&CriticalSection);
+
+	if (!Loader.IsValid() || (VideoSink == nullptr))
+	{
+		return;
+	}
+
+	if (Governor.IsValid() && (CurrentRate != 0.0f))
+	{
+		UpdateGovernor(DeltaTime);
+	}
+
+	// move prefetch window
+	int32 FrameIndex = FMath::Min((int32)(CurrentTime * CurrentFps), Loader->GetNumFrames() - 1);
+
+	if (FrameStep > 1)
+	{
+		FrameIndex -= FrameIndex % FrameStep;
+	}
+
+	Loader->RequestFrame(FrameIndex);
+
+	// skip frame if already processed
+	if (FrameIndex == LastFrameIndex)
+	{
+		if (OutputBuffers.Num() > 0)
 		{
-			ImagePaths.Add(FPaths::Combine(SequencePath, ImageFile));
+			UpdateOutputBuffers(FrameIndex);
 		}
 
-		CurrentDim = Dim;
+		return;
+	}
+
+	// skip frame if not loaded yet
+	TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> Frame = Loader->GetFrame(FrameIndex);
+
+	if (OutputBuffers.Num() > 0)
+	{
+		// buffered output displays the frame from the output buffers,
+		// which may be an earlier frame if the due one is not ready yet
+		Frame = UpdateOutputBuffers(FrameIndex);
+	}
+
+	const bool Playing = (CurrentRate != 0.0f) && (LastFrameIndex != INDEX_NONE);
+
+	if (!Frame.IsValid())
+	{
+		// a preview of the seek target is displayed until the target frame is ready
+		if (SeekStartTime > 0.0)
+		{
+			TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> PreviewFrame = Loader->GetPreviewFrame(FrameIndex);
+
+			if (PreviewFrame.IsValid())
+			{
+				DisplayFrame(*PreviewFrame, GetFrameTime(FrameIndex));
+				Stats.AddSeekLatency(FPlatformTime::Seconds() - SeekStartTime);
+				SeekStartTime = 0.0;
+			}
+		}
+
+		// the previous frame remains on display for another frame interval
+		if (Playing && (FrameIndex != LastLateFrameIndex))
+		{
+			Stats.AddRepeatedFrame();
+			LastLateFrameIndex = FrameIndex;
+		}
+
+		return;
+	}
+
+	// buffered output may display an earlier frame than the due one
+	FrameIndex = Frame->FrameIndex;
+
+	// frames between the previous and this frame were never displayed
+	if (Playing)
+	{
+		const int32 NumFrames = Loader->GetNumFrames();
+		const int32 Distance = (CurrentRate < 0.0f) ? (LastFrameIndex - FrameIndex) : (FrameIndex - LastFrameIndex);
+		const int32 NumSteps = ((Distance + NumFrames) % NumFrames) / FrameStep;
+
+		if (NumSteps > 1)
+		{
+			Stats.AddDroppedFrames(NumSteps - 1);
+		}
+	}
+
+	LastFrameIndex = FrameIndex;
+
+	if (Frame->Dim != CurrentDim)
+	{
+		UE_LOG(LogExrMedia, Warning, TEXT("Image frame %i is %s instead of %s"), FrameIndex, *Frame->Dim.ToString(), *CurrentDim.ToString());
+	}
+
+	DisplayFrame(*Frame, GetFrameTime(FrameIndex));
+
+	if (SeekStartTime > 0.0)
+	{
+		Stats.AddSeekLatency(FPlatformTime::Seconds() - SeekStartTime);
+		SeekStartTime = 0.0;
+	}
+}
+
+
+/* FExrMediaPlayer implementation
+ *****************************************************************************/
+
+void FExrMediaPlayer::CreateGovernor(int32 BaseProxyLevel)
+{
+	const int32 BaseLevel = FMath::Clamp(BaseProxyLevel, 0, 3);
+	const int32 MaxLevel = SequenceIndex->GetLayers()[SelectedVideoTrack].IsDefault() ? 3 : BaseLevel;
+
+	Governor = MakeShareable(new FExrMediaQualityGovernor(BaseLevel, MaxLevel));
+}
+
+
+void FExrMediaPlayer::DisplayFrame(const FExrMediaFrame& Frame, FTimespan Time)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ExrMedia_DisplayFrame);
+	EXRMEDIA_TRACE_SCOPE("Display Frame", Frame.FrameIndex);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	const EMediaTextureSinkMode SinkMode = (OutputBuffers.Num() > 0) ? EMediaTextureSinkMode::Buffered : EMediaTextureSinkMode::Unbuffered;
+
+	// re-initialize sink if format changed
+	if ((VideoSink->GetTextureSinkDimensions() != Frame.Dim) || (VideoSink->GetTextureSinkFormat() != Frame.Format) || (VideoSink->GetTextureSinkMode() != SinkMode))
+	{
+		if (!VideoSink->InitializeTextureSink(Frame.Dim, Frame.Dim, Frame.Format, SinkMode))
+		{
+			return;
+		}
+	}
+
+	if (SinkMode == EMediaTextureSinkMode::Buffered)
+	{
+		// the sink copies the frame into its back buffer; the render
+		// thread picks up the most recently displayed buffer on its own
+		VideoSink->UpdateTextureSinkBuffer(Frame.Data.GetData(), Frame.Stride);
+		VideoSink->DisplayTextureSinkBuffer(Time);
+		Stats.AddCopyTime(FPlatformTime::Seconds() - StartTime);
+
+		return;
+	}
+
+	// copy frame data
+	void* TextureBuffer = nullptr;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ExrMedia_AcquireSinkBuffer);
+		EXRMEDIA_TRACE_SCOPE("Acquire Sink Buffer", Frame.FrameIndex);
+
+		TextureBuffer = VideoSink->AcquireTextureSinkBuffer();
+	}
+
+	if (TextureBuffer != nullptr)
+	{
+		FMemory::Memcpy(TextureBuffer, Frame.Data.GetData(), Frame.Data.Num());
+
+		{
+			SCOPE_CYCLE_COUNTER(STAT_ExrMedia_ReleaseSinkBuffer);
+			EXRMEDIA_TRACE_SCOPE("Release Sink Buffer", Frame.FrameIndex);
+
+			VideoSink->ReleaseTextureSinkBuffer();
+		}
+
+		VideoSink->DisplayTextureSinkBuffer(Time);
+		Stats.AddCopyTime(FPlatformTime::Seconds() - StartTime);
+	}
+}
+
+
+void FExrMediaPlayer::FinishOpen()
+{
+	const TSharedRef<FPendingOpen, ESPMode::ThreadSafe> PendingRef = PendingOpen.ToSharedRef();
+	const FPendingOpen& Pending = PendingRef.Get();
+
+	PendingOpen.Reset();
+
+	const TSharedPtr<FExrMediaSequenceIndex, ESPMode::ThreadSafe> NewSequenceIndex = Pending.SequenceIndex;
+
+	if (!NewSequenceIndex.IsValid())
+	{
+		CurrentUrl.Empty();
+		MediaEvent.Broadcast(EMediaEvent::MediaOpenFailed);
+
+		return;
+	}
+
+	const FExrMediaFrameInfo& FirstFrame = NewSequenceIndex->GetFrameInfo(0);
+	const int32 NumMismatchedFrames = NewSequenceIndex->GetNumMismatchedFrames();
+
+	if (NumMismatchedFrames > 0)
+	{
+		UE_LOG(LogExrMedia, Warning, TEXT("%i frames in image sequence %s are not %s"), NumMismatchedFrames, *Pending.SequencePath, *FirstFrame.Dim.ToString());
+	}
+
+	// missing frames are skipped, so playback jumps over gaps in the numbering
+	TArray<FInt32Interval> Gaps;
+	const int32 NumMissingFrames = NewSequenceIndex->GetGaps(Gaps);
+
+	if (NumMissingFrames > 0)
+	{
+		UE_LOG(LogExrMedia, Warning, TEXT("%i frames in %i gaps are missing from image sequence %s (first gap: %i - %i)"), NumMissingFrames, Gaps.Num(), *Pending.SequencePath, Gaps[0].Min, Gaps[0].Max);
+	}
+
+	double Fps = Pending.FpsOverride;
+
+	if (Fps == 0.0)
+	{
+		Fps = (FirstFrame.FramesPerSecond > 0.0) ? FirstFrame.FramesPerSecond : 24.0;
+	}
+
+	// the shared decoder threads are split among all players, unless this one is limited further
+	const int32 DecoderThreads = (Pending.DecoderThreads > 0)
+		? FMath::Min(Pending.DecoderThreads, Scheduler->GetNumWorkers())
+		: Scheduler->GetNumWorkers();
+
+	// the worker already resolved the proxy level
+	FExrMediaDecodeOptions NewDecodeOptions = Pending.DecodeOptions;
+	{
+		NewDecodeOptions.DirectChannels = GetDefault<UExrMediaSettings>()->DirectChannelDecoding && NewSequenceIndex->IsHalfRgba();
+		NewDecodeOptions.ExposureScale = FMath::Pow(2.0f, Pending.Exposure);
+		NewDecodeOptions.MemoryMapped = GetDefault<UExrMediaSettings>()->MemoryMappedFiles;
+	}
+
+	// stripes are decoded by ParallelFor rather than OpenEXR's thread pool
+	if (GetDefault<UExrMediaSettings>()->StripedDecoding)
+	{
+		const int32 IntraFrameThreads = GetDefault<UExrMediaSettings>()->IntraFrameThreads;
+		NewDecodeOptions.NumStripes = (IntraFrameThreads > 0) ? IntraFrameThreads : FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+	}
+
+	if (Pending.OutputFormat == EExrMediaOutputFormat::Ldr)
+	{
+		NewDecodeOptions.OutputFormat = EMediaTextureSinkFormat::CharBGRA;
+	}
+
+	// the first layer is played until another track is selected
+	SelectTrackChannels(*NewSequenceIndex, 0, NewDecodeOptions);
+
+	if (NewDecodeOptions.MipLevel < Pending.ProxyLevel)
+	{
+		UE_LOG(LogExrMedia, Verbose, TEXT("Image sequence %s has no mip level %i, using level %i instead"), *Pending.SequencePath, Pending.ProxyLevel, NewDecodeOptions.MipLevel);
+	}
+
+	// finalize initialization
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		CurrentDim = Pending.Dim;
 		CurrentFps = Fps;
-		CurrentUrl = Url;
-		Duration = ImagePaths.Num() / Fps;
+		DecodeOptions = NewDecodeOptions;
+		Duration = NewSequenceIndex->GetNumFrames() / Fps;
+		FrameStep = 1;
+		Loader = MakeShareable(new FExrMediaLoader(NewSequenceIndex.ToSharedRef(), Scheduler, Pending.PrefetchDepth, DecoderThreads, DecodeOptions, Stats));
+		Loader->SetDirection((CurrentRate < 0.0f) ? -1 : 1);
+		Loader->SetFrameRate(CurrentFps * ((CurrentRate != 0.0f) ? FMath::Abs(CurrentRate) : 1.0f));
+		OutputBuffers.SetNum(FMath::Clamp(Pending.NumOutputBuffers, 0, NewSequenceIndex->GetNumFrames()));
+		ProxyLevel = Pending.ProxyLevel;
+		SelectedVideoTrack = 0;
+		SequenceIndex = NewSequenceIndex;
+
+		if (GetDefault<UExrMediaSettings>()->AdaptiveQuality)
+		{
+			CreateGovernor(Pending.ProxyLevel);
+		}
 	}
 
 	Info += TEXT("Image Sequence\n");
+	Info += FString::Printf(TEXT("    Packed: %s\n"), NewSequenceIndex->IsPacked() ? TEXT("Yes") : TEXT("No"));
 	Info += FString::Printf(TEXT("    Dimension: %i x %i\n"), CurrentDim.X, CurrentDim.Y);
-	Info += FString::Printf(TEXT("    Frames: %i\n"), ImagePaths.Num());
+	Info += FString::Printf(TEXT("    Frames: %i\n"), Loader->GetNumFrames());
+	Info += FString::Printf(TEXT("    File Pattern: %s%s%s\n"), *NewSequenceIndex->GetFramePattern().Prefix, *FString::ChrN(FMath::Max(1, NewSequenceIndex->GetFramePattern().Padding), TEXT('#')), *NewSequenceIndex->GetFramePattern().Suffix);
 	Info += FString::Printf(TEXT("    FPS: %f\n"), CurrentFps);
+	Info += FString::Printf(TEXT("    Channels: %s\n"), *FString::Join(NewSequenceIndex->GetChannelNames(), TEXT(", ")));
+
+	for (const FExrMediaLayer& Layer : NewSequenceIndex->GetLayers())
+	{
+		Info += FString::Printf(TEXT("    Layer: %s (Part %i, %s)\n"), *Layer.Name, Layer.Part, *FString::Join(Layer.ChannelNames, TEXT(", ")));
+	}
+
+	Info += FString::Printf(TEXT("    Mismatched Frames: %i\n"), NumMismatchedFrames);
+	Info += FString::Printf(TEXT("    Missing Frames: %i\n"), NumMissingFrames);
+	Info += FString::Printf(TEXT("    Decoder Threads: %i\n"), Loader->GetNumWorkers());
+	Info += FString::Printf(TEXT("    Output Buffers: %i\n"), OutputBuffers.Num());
+
+	if (DecodeOptions.OutputFormat == EMediaTextureSinkFormat::CharBGRA)
+	{
+		Info += FString::Printf(TEXT("    Output Format: 8-bit sRGB BGRA (Exposure %+.2f)\n"), Pending.Exposure);
+	}
+	else if (DecodeOptions.OutputFormat == EMediaTextureSinkFormat::FloatRGB)
+	{
+		Info += TEXT("    Output Format: 32-bit packed float RGB\n");
+	}
+	else
+	{
+		Info += TEXT("    Output Format: 16-bit float RGBA\n");
+	}
+
+	Info += FString::Printf(TEXT("    Decoded Channels: %s\n"), *((DecodeOptions.ChannelNames.Num() > 0) ? FString::Join(DecodeOptions.ChannelNames, TEXT(", ")) : FString(TEXT("RGBA"))));
+
+	Info += FString::Printf(TEXT("    Direct Channels: %s\n"), DecodeOptions.DirectChannels ? TEXT("Yes") : TEXT("No"));
+	Info += FString::Printf(TEXT("    Memory Mapped: %s\n"), DecodeOptions.MemoryMapped ? TEXT("Yes") : TEXT("No"));
+	Info += FString::Printf(TEXT("    Mip Level: %i of %i\n"), DecodeOptions.MipLevel, NewSequenceIndex->GetNumMipLevels());
+	Info += FString::Printf(TEXT("    Subsampling: 1/%i\n"), DecodeOptions.SubsampleFactor);
+	Info += FString::Printf(TEXT("    Adaptive Quality: %s\n"), Governor.IsValid() ? TEXT("Yes") : TEXT("No"));
 
 	// notify listeners
 	MediaEvent.Broadcast(EMediaEvent::TracksChanged);
 	MediaEvent.Broadcast(EMediaEvent::MediaOpened);
-
-	return true;
 }
 
 
-bool FExrMediaPlayer::Open(const TSharedRef<FArchive, ESPMode::ThreadSafe>& Archive, const FString& OriginalUrl, const IMediaOptions& Options)
+FTimespan FExrMediaPlayer::GetFrameTime(int32 FrameIndex) const
 {
-	return false; // not supported
+	return FTimespan::FromSeconds(FrameIndex / CurrentFps);
 }
 
 
-void FExrMediaPlayer::TickPlayer(float DeltaTime)
+bool FExrMediaPlayer::IsValidVideoTrack(int32 TrackIndex) const
 {
-	// do nothing
+	return SequenceIndex.IsValid() && SequenceIndex->GetLayers().IsValidIndex(TrackIndex);
 }
 
 
-void FExrMediaPlayer::TickVideo(float DeltaTime)
+FIntPoint FExrMediaPlayer::ResolveProxyLevel(const FExrMediaSequenceIndex& InSequenceIndex, int32 TrackIndex, int32 InProxyLevel, FExrMediaDecodeOptions& InOutDecodeOptions)
 {
-	if (Duration == 0.0f)
+	const FIntPoint Dim = InSequenceIndex.GetFrameInfo(0).Dim;
+
+	// mip levels and subsampling only exist for the RGBA channels of the first part
+	if (!InSequenceIndex.GetLayers()[TrackIndex].IsDefault())
 	{
-		return;
+		InOutDecodeOptions.MipLevel = 0;
+		InOutDecodeOptions.SubsampleFactor = 1;
+
+		return Dim;
 	}
 
-	// update clock
-	CurrentTime += DeltaTime * CurrentRate;
-	CurrentTime = FMath::Fmod(CurrentTime, Duration);
+	// proxy resolutions are read from the mip levels of tiled images if available
+	InOutDecodeOptions.MipLevel = FMath::Clamp(InProxyLevel, 0, InSequenceIndex.GetNumMipLevels() - 1);
+	InOutDecodeOptions.SubsampleFactor = 1;
 
-	FScopeLock Lock(&CriticalSection);
+	if (InOutDecodeOptions.MipLevel > 0)
+	{
+		return InSequenceIndex.GetMipDim(InOutDecodeOptions.MipLevel);
+	}
 
-	if ((ImagePaths.Num() == 0) || (VideoSink == nullptr))
+	if (InProxyLevel > 0)
+	{
+		// images without mip levels are subsampled while decoding instead
+		InOutDecodeOptions.SubsampleFactor = 1 << FMath::Min(InProxyLevel, 3);
+
+		return FIntPoint(
+			FMath::DivideAndRoundUp(Dim.X, InOutDecodeOptions.SubsampleFactor),
+			FMath::DivideAndRoundUp(Dim.Y, InOutDecodeOptions.SubsampleFactor)
+		);
+	}
+
+	return Dim;
+}
+
+
+void FExrMediaPlayer::SelectTrackChannels(const FExrMediaSequenceIndex& InSequenceIndex, int32 TrackIndex, FExrMediaDecodeOptions& InOutDecodeOptions) const
+{
+	const FExrMediaLayer& Layer = InSequenceIndex.GetLayers()[TrackIndex];
+
+	InOutDecodeOptions.ChannelNames.Empty();
+	InOutDecodeOptions.Part = Layer.Part;
+
+	if (!Layer.IsDefault())
+	{
+		InOutDecodeOptions.ChannelNames = Layer.ChannelNames;
+
+		// single channel layers (i.e. depth or mattes) are decoded into one channel and
+		// shown as gray, like single channel images; two channel layers are shown as RG
+		if (InOutDecodeOptions.ChannelNames.Num() > 1)
+		{
+			ExrMediaPadChannelNames(Layer, 3, InOutDecodeOptions.ChannelNames);
+		}
+	}
+	else if (GetDefault<UExrMediaSettings>()->DirectChannelDecoding && InSequenceIndex.HasUniformChannels())
+	{
+		// single channel and RGB sequences are decoded without filling in constant channels
+		const TArray<FString>& ChannelNames = InSequenceIndex.GetChannelNames();
+
+		if (ChannelNames.Num() == 1)
+		{
+			InOutDecodeOptions.ChannelNames = ChannelNames;
+		}
+		else if ((ChannelNames.Num() == 3) && ChannelNames.Contains(TEXT("R")) && ChannelNames.Contains(TEXT("G")) && ChannelNames.Contains(TEXT("B")))
+		{
+			InOutDecodeOptions.ChannelNames = { TEXT("R"), TEXT("G"), TEXT("B") };
+		}
+	}
+
+	if (InOutDecodeOptions.OutputFormat == EMediaTextureSinkFormat::CharBGRA)
 	{
 		return;
 	}
 
-	// skip frame if already processed
-	const int32 FrameIndex = (int)(CurrentTime * CurrentFps);
+	if ((InOutDecodeOptions.ChannelNames.Num() > 0) && (InOutDecodeOptions.ChannelNames.Num() < 4) && ((VideoSink == nullptr) || VideoSink->SupportsTextureSinkFormat(EMediaTextureSinkFormat::FloatRGB)))
+	{
+		// without alpha, the pixels fit into the packed 32-bit float format
+		InOutDecodeOptions.OutputFormat = EMediaTextureSinkFormat::FloatRGB;
+	}
+	else if (Layer.IsDefault())
+	{
+		InOutDecodeOptions.ChannelNames.Empty();
+		InOutDecodeOptions.OutputFormat = EMediaTextureSinkFormat::FloatRGBA;
+	}
+	else
+	{
+		// single channel layers are expanded to gray RGBA after decoding
+		if (InOutDecodeOptions.ChannelNames.Num() > 1)
+		{
+			ExrMediaPadChannelNames(Layer, 4, InOutDecodeOptions.ChannelNames);
+		}
 
-	if (FrameIndex == LastFrameIndex)
+		InOutDecodeOptions.OutputFormat = EMediaTextureSinkFormat::FloatRGBA;
+	}
+}
+
+
+void FExrMediaPlayer::UpdateGovernor(float DeltaTime)
+{
+	const int32 OldProxyLevel = Governor->GetProxyLevel();
+
+	// other players' loaders decode on the same scheduler workers
+	const int32 NumWorkers = FMath::Min(Loader->GetNumWorkers(), Scheduler->GetWorkerShare());
+
+	if (!Governor->Update(DeltaTime, Loader->GetAverageDecodeTime(), NumWorkers, CurrentFps * FMath::Abs(CurrentRate)))
 	{
 		return;
 	}
 
-	LastFrameIndex = FrameIndex;
+	FrameStep = Governor->GetFrameStep();
+	Loader->SetFrameStep(FrameStep);
 
-	// fetch frame
-	const FString ImagePath = ImagePaths[FrameIndex];
+	if (Governor->GetProxyLevel() != OldProxyLevel)
+	{
+		const int32 OldMipLevel = DecodeOptions.MipLevel;
+		const int32 OldSubsampleFactor = DecodeOptions.SubsampleFactor;
 
-	FRgbaInputFile InputFile(ImagePath);
-	FIntPoint Dim = InputFile.GetDataWindow();
+		ProxyLevel = Governor->GetProxyLevel();
+		CurrentDim = ResolveProxyLevel(*SequenceIndex, SelectedVideoTrack, ProxyLevel, DecodeOptions);
 
-	if (Dim != CurrentDim)
+		// changing the decode options empties the frame cache, so
+		// proxy levels that resolve to the same options are skipped
+		if ((DecodeOptions.MipLevel != OldMipLevel) || (DecodeOptions.SubsampleFactor != OldSubsampleFactor))
+		{
+			Loader->SetDecodeOptions(DecodeOptions);
+		}
+	}
+
+	for (FOutputBuffer& Buffer : OutputBuffers)
 	{
-		UE_LOG(LogExrMedia, Warning, TEXT("Image frame %s is %s instead of %s"), *ImagePath, *Dim.ToString(), *CurrentDim.ToString());
+		Buffer.Frame.Reset();
 	}
 
-	// re-initialize sink if format changed
-	if (VideoSink->GetTextureSinkDimensions() != Dim)
+	// media events must be broadcast on the game thread
+	DeferredEvents.Enqueue(EMediaEvent::TracksChanged);
+}
+
+
+TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> FExrMediaPlayer::UpdateOutputBuffers(int32 FrameIndex)
+{
+	const int32 Direction = Loader->GetDirection();
+	const int32 NumBuffers = OutputBuffers.Num();
+	const int32 NumFrames = Loader->GetNumFrames();
+
+	// hold on to the frames that are due next in the playback direction, so that they
+	// remain available for display even if decoding temporarily falls behind the frame rate;
+	// buffers are ordered by their offset from the due frame, because slots derived from
+	// frame indices would collide where the window wraps around the end of the sequence
+	TArray<FOutputBuffer> NewBuffers;
+	NewBuffers.SetNum(NumBuffers);
+
+	for (int32 Offset = 0; Offset < NumBuffers; ++Offset)
 	{
-		if (!VideoSink->InitializeTextureSink(Dim, Dim, EMediaTextureSinkFormat::FloatRGBA, EMediaTextureSinkMode::Unbuffered))
+		const int32 BufferFrameIndex = ((FrameIndex + Direction * Offset * FrameStep) % NumFrames + NumFrames) % NumFrames;
+		const FOutputBuffer* OldBuffer = OutputBuffers.FindByPredicate([BufferFrameIndex](const FOutputBuffer& Buffer) {
+			return Buffer.Frame.IsValid() && (Buffer.Frame->FrameIndex == BufferFrameIndex);
+		});
+
+		if (OldBuffer != nullptr)
 		{
-			return;
+			NewBuffers[Offset] = *OldBuffer;
+		}
+		else
+		{
+			NewBuffers[Offset].Frame = Loader->PeekFrame(BufferFrameIndex);
+			NewBuffers[Offset].Time = GetFrameTime(BufferFrameIndex);
 		}
 	}
 
-	// read frame data
-	void* TextureBuffer = VideoSink->AcquireTextureSinkBuffer();
+	// the first buffer holds the frame whose presentation time is due
+	TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> Frame = NewBuffers[0].Frame;
 
-	if (TextureBuffer != nullptr)
+	if (!Frame.IsValid() && (CurrentRate != 0.0f) && (LastFrameIndex != INDEX_NONE))
 	{
-		InputFile.SetFrameBuffer(TextureBuffer, CurrentDim);
-		InputFile.ReadPixels(0, CurrentDim.Y - 1);
+		// if decoding fell behind, the newest frame whose time has passed since the previously
+		// displayed frame is shown instead, rather than holding the previous frame until the
+		// due frame is ready; frames that were buffered ahead of time are still held for this
+		for (int32 Offset = 1; (Offset < NumBuffers) && !Frame.IsValid(); ++Offset)
+		{
+			const int32 PastFrameIndex = ((FrameIndex - Direction * Offset * FrameStep) % NumFrames + NumFrames) % NumFrames;
 
-		VideoSink->ReleaseTextureSinkBuffer();
-		VideoSink->DisplayTextureSinkBuffer(FTimespan::FromSeconds(CurrentTime));
+			if (PastFrameIndex == LastFrameIndex)
+			{
+				break;
+			}
+
+			const FOutputBuffer* PastBuffer = OutputBuffers.FindByPredicate([PastFrameIndex](const FOutputBuffer& Buffer) {
+				return Buffer.Frame.IsValid() && (Buffer.Frame->FrameIndex == PastFrameIndex);
+			});
+
+			Frame = (PastBuffer != nullptr) ? PastBuffer->Frame : Loader->PeekFrame(PastFrameIndex);
+		}
 	}
+
+	OutputBuffers = MoveTemp(NewBuffers);
+
+	return Frame;
 }
 
 
@@ -393,8 +1064,31 @@ void FExrMediaPlayer::SetVideoSink(IMediaTextureSink* Sink)
 
 	if (Sink != nullptr)
 	{
-		Sink->InitializeTextureSink(CurrentDim, CurrentDim, EMediaTextureSinkFormat::FloatRGBA, EMediaTextureSinkMode::Unbuffered);
+		// not all sinks can take packed floating point RGB pixels
+		if ((DecodeOptions.OutputFormat == EMediaTextureSinkFormat::FloatRGB) && !Sink->SupportsTextureSinkFormat(EMediaTextureSinkFormat::FloatRGB))
+		{
+			DecodeOptions.OutputFormat = EMediaTextureSinkFormat::FloatRGBA;
+
+			if (SequenceIndex.IsValid())
+			{
+				SelectTrackChannels(*SequenceIndex, SelectedVideoTrack, DecodeOptions);
+			}
+			else
+			{
+				DecodeOptions.ChannelNames.Empty();
+			}
+
+			if (Loader.IsValid())
+			{
+				Loader->SetDecodeOptions(DecodeOptions);
+			}
+		}
+
+		const EMediaTextureSinkMode SinkMode = (OutputBuffers.Num() > 0) ? EMediaTextureSinkMode::Buffered : EMediaTextureSinkMode::Unbuffered;
+		Sink->InitializeTextureSink(CurrentDim, CurrentDim, DecodeOptions.OutputFormat, SinkMode);
 	}
+
+	LastFrameIndex = INDEX_NONE;
 }
 
 
@@ -415,12 +1109,12 @@ uint32 FExrMediaPlayer::GetAudioTrackSampleRate(int32 TrackIndex) const
 
 int32 FExrMediaPlayer::GetNumTracks(EMediaTrackType TrackType) const
 {
-	if (CurrentUrl.IsEmpty() || (TrackType != EMediaTrackType::Video))
+	if (CurrentUrl.IsEmpty() || (TrackType != EMediaTrackType::Video) || !SequenceIndex.IsValid())
 	{
 		return 0;
 	}
 
-	return 1;
+	return SequenceIndex->GetLayers().Num();
 }
 
 
@@ -437,18 +1131,18 @@ int32 FExrMediaPlayer::GetSelectedTrack(EMediaTrackType TrackType) const
 
 FText FExrMediaPlayer::GetTrackDisplayName(EMediaTrackType TrackType, int32 TrackIndex) const
 {
-	if (CurrentUrl.IsEmpty() || (TrackType != EMediaTrackType::Video) || (TrackIndex != 0))
+	if (CurrentUrl.IsEmpty() || (TrackType != EMediaTrackType::Video) || !IsValidVideoTrack(TrackIndex))
 	{
 		return FText::GetEmpty();
 	}
 
-	return LOCTEXT("DefaultVideoTrackName", "Video Track");
+	return FText::FromString(SequenceIndex->GetLayers()[TrackIndex].Name);
 }
 
 
 FString FExrMediaPlayer::GetTrackLanguage(EMediaTrackType TrackType, int32 TrackIndex) const
 {
-	if (CurrentUrl.IsEmpty() || (TrackType != EMediaTrackType::Video) || (TrackIndex != 0))
+	if (CurrentUrl.IsEmpty() || (TrackType != EMediaTrackType::Video) || !IsValidVideoTrack(TrackIndex))
 	{
 		return FString();
 	}
@@ -459,18 +1153,18 @@ FString FExrMediaPlayer::GetTrackLanguage(EMediaTrackType TrackType, int32 Track
 
 FString FExrMediaPlayer::GetTrackName(EMediaTrackType TrackType, int32 TrackIndex) const
 {
-	if (CurrentUrl.IsEmpty() || (TrackType != EMediaTrackType::Video) || (TrackIndex != 0))
+	if (CurrentUrl.IsEmpty() || (TrackType != EMediaTrackType::Video) || !IsValidVideoTrack(TrackIndex))
 	{
 		return FString();
 	}
 
-	return TEXT("VideoTrack");
+	return SequenceIndex->GetLayers()[TrackIndex].Name;
 }
 
 
 uint32 FExrMediaPlayer::GetVideoTrackBitRate(int32 TrackIndex) const
 {
-	if (CurrentUrl.IsEmpty() || (TrackIndex != 0))
+	if (CurrentUrl.IsEmpty() || !IsValidVideoTrack(TrackIndex))
 	{
 		return 0;
 	}
@@ -481,7 +1175,7 @@ uint32 FExrMediaPlayer::GetVideoTrackBitRate(int32 TrackIndex) const
 
 FIntPoint FExrMediaPlayer::GetVideoTrackDimensions(int32 TrackIndex) const
 {
-	if (CurrentUrl.IsEmpty() || (TrackIndex != 0))
+	if (CurrentUrl.IsEmpty() || !IsValidVideoTrack(TrackIndex))
 	{
 		return FIntPoint::ZeroValue;
 	}
@@ -492,7 +1186,7 @@ FIntPoint FExrMediaPlayer::GetVideoTrackDimensions(int32 TrackIndex) const
 
 float FExrMediaPlayer::GetVideoTrackFrameRate(int32 TrackIndex) const
 {
-	if (CurrentUrl.IsEmpty() || (TrackIndex != 0))
+	if (CurrentUrl.IsEmpty() || !IsValidVideoTrack(TrackIndex))
 	{
 		return 0;
 	}
@@ -503,12 +1197,51 @@ float FExrMediaPlayer::GetVideoTrackFrameRate(int32 TrackIndex) const
 
 bool FExrMediaPlayer::SelectTrack(EMediaTrackType TrackType, int32 TrackIndex)
 {
-	if (CurrentUrl.IsEmpty() || (TrackType != EMediaTrackType::Video) || (TrackIndex != 0))
+	if (CurrentUrl.IsEmpty() || (TrackType != EMediaTrackType::Video) || !IsValidVideoTrack(TrackIndex))
 	{
 		return false;
 	}
 
+	if (TrackIndex == SelectedVideoTrack)
+	{
+		return true;
+	}
+
+	FScopeLock Lock(&CriticalSection);
+
 	SelectedVideoTrack = TrackIndex;
 
+	// the new layer's quality ladder starts over at the base level
+	if (Governor.IsValid())
+	{
+		FrameStep = 1;
+		ProxyLevel = Governor->GetBaseProxyLevel();
+		Loader->SetFrameStep(FrameStep);
+		CreateGovernor(ProxyLevel);
+	}
+
+	// other layers may need a different output format and have no proxy resolutions
+	if (DecodeOptions.OutputFormat != EMediaTextureSinkFormat::CharBGRA)
+	{
+		DecodeOptions.OutputFormat = EMediaTextureSinkFormat::FloatRGBA;
+	}
+
+	SelectTrackChannels(*SequenceIndex, TrackIndex, DecodeOptions);
+	CurrentDim = ResolveProxyLevel(*SequenceIndex, TrackIndex, ProxyLevel, DecodeOptions);
+	Loader->SetDecodeOptions(DecodeOptions);
+
+	for (FOutputBuffer& Buffer : OutputBuffers)
+	{
+		Buffer.Frame.Reset();
+	}
+
+	if (VideoSink != nullptr)
+	{
+		const EMediaTextureSinkMode SinkMode = (OutputBuffers.Num() > 0) ? EMediaTextureSinkMode::Buffered : EMediaTextureSinkMode::Unbuffered;
+		VideoSink->InitializeTextureSink(CurrentDim, CurrentDim, DecodeOptions.OutputFormat, SinkMode);
+	}
+
+	LastFrameIndex = INDEX_NONE;
+
 	return true;
 }
@@ -3,19 +3,37 @@
 #pragma once
 
 #include "CoreTypes.h"
+#include "Async/Future.h"
 #include "Containers/Array.h"
+#include "Containers/Queue.h"
 #include "Containers/UnrealString.h"
+#include "ExrMediaDecodeOptions.h"
+#include "ExrMediaSource.h"
+#include "ExrMediaStats.h"
+#include "HAL/ThreadSafeBool.h"
 #include "IMediaControls.h"
 #include "IMediaPlayer.h"
 #include "IMediaOutput.h"
 #include "IMediaTracks.h"
 #include "Math/IntPoint.h"
+#include "Misc/Timespan.h"
+#include "Templates/SharedPointer.h"
 
+class FExrMediaDecodeScheduler;
+class FExrMediaLoader;
+class FExrMediaQualityGovernor;
+class FExrMediaSequenceIndex;
 class IMediaTextureSink;
+struct FExrMediaFrame;
 
 
 /**
  * Implements a media player EXR image sequences.
+ *
+ * Sequences are opened asynchronously: Open returns right away, and the player
+ * remains in the Preparing state while the sequence is scanned and its headers
+ * are probed on a worker thread. The player finishes opening on the next tick
+ * after the scan completed, and then broadcasts TracksChanged and MediaOpened.
  */
 class FExrMediaPlayer
 	: public IMediaControls
@@ -25,8 +43,12 @@ class FExrMediaPlayer
 {
 public:
 
-	/** Default constructor. */
-	FExrMediaPlayer();
+	/**
+	 * Create and initialize a new instance.
+	 *
+	 * @param InScheduler The decode scheduler that all players share.
+	 */
+	FExrMediaPlayer(const TSharedRef<FExrMediaDecodeScheduler, ESPMode::ThreadSafe>& InScheduler);
 
 	/** Destructor. */
 	~FExrMediaPlayer();
@@ -96,8 +118,148 @@ public:
 	virtual float GetVideoTrackFrameRate(int32 TrackIndex) const override;
 	virtual bool SelectTrack(EMediaTrackType TrackType, int32 TrackIndex) override;
 
+protected:
+
+	/**
+	 * Finish opening the sequence whose scan has completed.
+	 *
+	 * Called on the game thread.
+	 */
+	void FinishOpen();
+
+	/**
+	 * Create the quality governor for the selected video track.
+	 *
+	 * Only the default layer has proxy resolutions, so the governor
+	 * of any other layer adapts the quality by skipping frames only.
+	 *
+	 * @param BaseProxyLevel The proxy level selected by the user (0 = full resolution).
+	 */
+	void CreateGovernor(int32 BaseProxyLevel);
+
+	/**
+	 * Copy the specified frame into the video sink and display it.
+	 *
+	 * @param Frame The frame to display.
+	 * @param Time The frame's presentation time.
+	 */
+	void DisplayFrame(const FExrMediaFrame& Frame, FTimespan Time);
+
+	/**
+	 * Get the presentation time of the specified frame.
+	 *
+	 * @param FrameIndex Index of the frame.
+	 * @return Presentation time.
+	 */
+	FTimespan GetFrameTime(int32 FrameIndex) const;
+
+	/**
+	 * Check whether the specified video track exists.
+	 *
+	 * @param TrackIndex Index of the video track.
+	 * @return true if the track exists, false otherwise.
+	 */
+	bool IsValidVideoTrack(int32 TrackIndex) const;
+
+	/**
+	 * Get the decode options and frame dimensions for the specified proxy level.
+	 *
+	 * Layers other than the default one are always decoded at full resolution.
+	 *
+	 * @param InSequenceIndex Header index of the image sequence.
+	 * @param TrackIndex Index of the video track (= layer) that is decoded.
+	 * @param InProxyLevel The proxy level (0 = full resolution).
+	 * @param InOutDecodeOptions The decode options whose proxy settings will be updated.
+	 * @return Dimensions of the frames at the proxy level.
+	 */
+	static FIntPoint ResolveProxyLevel(const FExrMediaSequenceIndex& InSequenceIndex, int32 TrackIndex, int32 InProxyLevel, FExrMediaDecodeOptions& InOutDecodeOptions);
+
+	/**
+	 * Select the part, channels and output format for decoding the specified video track.
+	 *
+	 * 8-bit output is kept; other output formats are chosen based on the layer's channels and the video sink.
+	 *
+	 * @param InSequenceIndex Header index of the image sequence.
+	 * @param TrackIndex Index of the video track (= layer) to decode.
+	 * @param InOutDecodeOptions The decode options whose channel settings will be updated.
+	 */
+	void SelectTrackChannels(const FExrMediaSequenceIndex& InSequenceIndex, int32 TrackIndex, FExrMediaDecodeOptions& InOutDecodeOptions) const;
+
+	/**
+	 * Update the quality governor and apply its decisions.
+	 *
+	 * The caller must hold the critical section.
+	 *
+	 * @param DeltaTime Time since the last update (in seconds).
+	 */
+	void UpdateGovernor(float DeltaTime);
+
+	/**
+	 * Fill the output buffers with the frames that are due next, and pick the frame to display.
+	 *
+	 * While playing, a frame whose time has passed since the previously displayed
+	 * frame is picked if the frame that is due now is not decoded yet.
+	 *
+	 * @param FrameIndex Index of the frame that is due now.
+	 * @return The frame to display, or nullptr if there is no newer frame to display.
+	 */
+	TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> UpdateOutputBuffers(int32 FrameIndex);
+
 private:
 
+	/** A decoded frame that is waiting to be displayed. */
+	struct FOutputBuffer
+	{
+		/** The decoded frame, or nullptr if it has not been decoded yet. */
+		TSharedPtr<FExrMediaFrame, ESPMode::ThreadSafe> Frame;
+
+		/** The frame's presentation time. */
+		FTimespan Time;
+	};
+
+	/** A sequence that is being opened, shared with the worker that scans it. */
+	struct FPendingOpen
+	{
+		/** Whether the open was cancelled by closing the player. */
+		FThreadSafeBool Cancelled;
+
+		/** Whether the worker has finished scanning the sequence. */
+		FThreadSafeBool Completed;
+
+		/** Number of decoder threads to use (0 = automatic). */
+		int32 DecoderThreads;
+
+		/** Options for decoding frames at the requested proxy level (set by the worker). */
+		FExrMediaDecodeOptions DecodeOptions;
+
+		/** Dimensions of the frames at the requested proxy level (set by the worker). */
+		FIntPoint Dim;
+
+		/** Exposure adjustment for 8-bit output (in stops). */
+		float Exposure;
+
+		/** Frame rate that overrides the one in the image headers (0.0 = no override). */
+		double FpsOverride;
+
+		/** Number of output buffers to use (0 = unbuffered output). */
+		int32 NumOutputBuffers;
+
+		/** The requested output format. */
+		EExrMediaOutputFormat OutputFormat;
+
+		/** Number of frames to decode ahead of the play head. */
+		int32 PrefetchDepth;
+
+		/** The requested proxy level (0 = full resolution). */
+		int32 ProxyLevel;
+
+		/** The scanned sequence (set by the worker; nullptr = failed to open). */
+		TSharedPtr<FExrMediaSequenceIndex, ESPMode::ThreadSafe> SequenceIndex;
+
+		/** Path to the image sequence directory or sequence container file. */
+		FString SequencePath;
+	};
+
 	/** Critical section for synchronizing access to receiver and sinks. */
 	FCriticalSection CriticalSection;
 
@@ -119,11 +281,20 @@ private:
 	/** The URL of the currently opened media. */
 	FString CurrentUrl;
 
+	/** Options that frames are currently decoded with. */
+	FExrMediaDecodeOptions DecodeOptions;
+
+	/** Media events that are waiting to be broadcast on the game thread. */
+	TQueue<EMediaEvent, EQueueMode::Mpsc> DeferredEvents;
+
 	/** The duration of the media. */
     float Duration;
 
-	/** Paths to each EXR image in the currently opened sequence. */
-	TArray<FString> ImagePaths;
+	/** Number of frames to advance between displayed frames. */
+	int32 FrameStep;
+
+	/** Adapts the playback quality to the decode throughput (nullptr = disabled). */
+	TSharedPtr<FExrMediaQualityGovernor> Governor;
 
 	/** Media information string. */
 	FString Info;
@@ -131,12 +302,42 @@ private:
 	/** Index of the last processed image sequence frame. */
 	int32 LastFrameIndex;
 
+	/** Index of the last frame that was not decoded in time for display. */
+	int32 LastLateFrameIndex;
+
+	/** The image sequence frame loader. */
+	TSharedPtr<FExrMediaLoader> Loader;
+
 	/** Holds an event delegate that is invoked when a media event occurred. */
 	FOnMediaEvent MediaEvent;
 
+	/** Completes when the worker of the most recent open has finished. */
+	TFuture<void> OpenFuture;
+
+	/** Frames that are due next, by offset from the due frame (empty = unbuffered output). */
+	TArray<FOutputBuffer> OutputBuffers;
+
+	/** The sequence that is being opened (nullptr = not opening). */
+	TSharedPtr<FPendingOpen, ESPMode::ThreadSafe> PendingOpen;
+
+	/** The proxy level that the default layer is decoded at (0 = full resolution). */
+	int32 ProxyLevel;
+
+	/** The decode scheduler that all players share. */
+	TSharedRef<FExrMediaDecodeScheduler, ESPMode::ThreadSafe> Scheduler;
+
+	/** Time at which the most recent seek started (in seconds, 0.0 = target frame displayed). */
+	double SeekStartTime;
+
 	/** Index of the selected video track. */
 	int32 SelectedVideoTrack;
 
+	/** Header index of the currently opened image sequence. */
+	TSharedPtr<FExrMediaSequenceIndex, ESPMode::ThreadSafe> SequenceIndex;
+
+	/** Playback statistics of the currently opened sequence. */
+	FExrMediaPlaybackStats Stats;
+
 	/** Should the video loop to the beginning at completion */
     bool ShouldLoop;
 	
@@ -0,0 +1,100 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "ExrMediaQualityGovernor.h"
+#include "ExrMediaPrivate.h"
+
+#include "Math/UnrealMathUtility.h"
+
+
+const float FExrMediaQualityGovernor::OverloadDelay = 0.5f;
+const float FExrMediaQualityGovernor::SettleDelay = 1.0f;
+const float FExrMediaQualityGovernor::UnderloadDelay = 3.0f;
+
+
+/* FExrMediaQualityGovernor structors
+ *****************************************************************************/
+
+FExrMediaQualityGovernor::FExrMediaQualityGovernor(int32 InBaseProxyLevel, int32 InMaxProxyLevel)
+	: Level(0)
+	, Load(0.0f)
+	, NumSwitches(0)
+	, OverloadTime(0.0f)
+	, SettleTime(0.0f)
+	, UnderloadTime(0.0f)
+{
+	// skipping every other frame halves the cost, while each proxy level quarters it;
+	// alternating the two keeps the steps between levels small
+	for (int32 ProxyLevel = InBaseProxyLevel; ProxyLevel <= FMath::Max(InBaseProxyLevel, InMaxProxyLevel); ++ProxyLevel)
+	{
+		const double Cost = 1.0 / (1 << (2 * (ProxyLevel - InBaseProxyLevel)));
+
+		Levels.Add({ Cost, 1, ProxyLevel });
+		Levels.Add({ Cost * 0.5, 2, ProxyLevel });
+	}
+}
+
+
+/* FExrMediaQualityGovernor interface
+ *****************************************************************************/
+
+bool FExrMediaQualityGovernor::Update(float DeltaTime, double DecodeTime, int32 NumWorkers, double FramesPerSecond)
+{
+	if ((DecodeTime <= 0.0) || (FramesPerSecond <= 0.0))
+	{
+		return false;
+	}
+
+	const double AvailableTime = NumWorkers * GetFrameStep() / FramesPerSecond;
+
+	Load = DecodeTime / AvailableTime;
+
+	if (SettleTime > 0.0f)
+	{
+		SettleTime -= DeltaTime;
+		return false;
+	}
+
+	const int32 OldLevel = Level;
+
+	// step down if decoding keeps falling behind
+	OverloadTime = (Load > 1.0f) ? OverloadTime + DeltaTime : 0.0f;
+
+	if ((OverloadTime > OverloadDelay) && (Level < Levels.Num() - 1))
+	{
+		++Level;
+	}
+
+	// step up if the next higher level fits with some headroom
+	if ((Level == OldLevel) && (Level > 0))
+	{
+		const float HigherLoad = Load * Levels[Level - 1].Cost / Levels[Level].Cost;
+
+		UnderloadTime = (HigherLoad < 0.75f) ? UnderloadTime + DeltaTime : 0.0f;
+
+		if (UnderloadTime > UnderloadDelay)
+		{
+			--Level;
+		}
+	}
+
+	if (Level == OldLevel)
+	{
+		return false;
+	}
+
+	LastSwitch = FString::Printf(TEXT("%s to level %i (proxy level %i, every %s frame) at load %.2f"),
+		(Level > OldLevel) ? TEXT("Down") : TEXT("Up"),
+		Level,
+		GetProxyLevel(),
+		(GetFrameStep() > 1) ? TEXT("2nd") : TEXT("1st"),
+		Load);
+
+	UE_LOG(LogExrMedia, Verbose, TEXT("Quality governor: %s"), *LastSwitch);
+
+	++NumSwitches;
+	OverloadTime = 0.0f;
+	SettleTime = SettleDelay;
+	UnderloadTime = 0.0f;
+
+	return true;
+}
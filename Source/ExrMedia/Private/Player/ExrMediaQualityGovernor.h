@@ -0,0 +1,171 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "Containers/UnrealString.h"
+
+
+/**
+ * Adapts the playback quality of an image sequence to the available decode throughput.
+ *
+ * The governor compares the time it takes to decode a frame with the time that
+ * is available for it, i.e. the interval between displayed frames multiplied by
+ * the number of decoder threads. When decoding falls behind for a while, it steps
+ * down a ladder of quality levels that skip frames or reduce the resolution. When
+ * the next higher level would fit comfortably, it steps back up.
+ */
+class FExrMediaQualityGovernor
+{
+public:
+
+	/**
+	 * Create and initialize a new instance.
+	 *
+	 * @param InBaseProxyLevel The proxy level selected by the user (0 = full resolution).
+	 * @param InMaxProxyLevel The highest proxy level that the sequence supports (base level = skip frames only).
+	 */
+	FExrMediaQualityGovernor(int32 InBaseProxyLevel, int32 InMaxProxyLevel);
+
+public:
+
+	/**
+	 * Get the proxy level at the highest quality level.
+	 *
+	 * @return Base proxy level (0 = full resolution).
+	 */
+	int32 GetBaseProxyLevel() const
+	{
+		return Levels[0].ProxyLevel;
+	}
+
+	/**
+	 * Get the number of frames to advance between decoded frames at the current level.
+	 *
+	 * @return Frame step (1 = every frame is decoded).
+	 */
+	int32 GetFrameStep() const
+	{
+		return Levels[Level].FrameStep;
+	}
+
+	/**
+	 * Get the current quality level.
+	 *
+	 * @return Quality level (0 = highest quality).
+	 */
+	int32 GetLevel() const
+	{
+		return Level;
+	}
+
+	/**
+	 * Get the most recently measured decode load.
+	 *
+	 * @return Decode time relative to the available time (1.0 = decoding just keeps up).
+	 */
+	float GetLoad() const
+	{
+		return Load;
+	}
+
+	/**
+	 * Get the number of quality levels.
+	 *
+	 * @return Number of levels.
+	 */
+	int32 GetNumLevels() const
+	{
+		return Levels.Num();
+	}
+
+	/**
+	 * Get the number of times the quality level changed.
+	 *
+	 * @return Number of switches.
+	 */
+	int32 GetNumSwitches() const
+	{
+		return NumSwitches;
+	}
+
+	/**
+	 * Get the proxy level to decode frames at the current level.
+	 *
+	 * @return Proxy level (0 = full resolution).
+	 */
+	int32 GetProxyLevel() const
+	{
+		return Levels[Level].ProxyLevel;
+	}
+
+	/**
+	 * Get a human readable description of the most recent switch.
+	 *
+	 * @return Switch description, or an empty string if the level never changed.
+	 */
+	const FString& GetLastSwitch() const
+	{
+		return LastSwitch;
+	}
+
+	/**
+	 * Update the governor with the latest decode measurements.
+	 *
+	 * @param DeltaTime Time since the last update (in seconds).
+	 * @param DecodeTime Average time to decode a frame at the current level (in seconds, 0.0 = not measured yet).
+	 * @param NumWorkers Number of frames that are decoded in parallel.
+	 * @param FramesPerSecond Number of sequence frames that are played per second.
+	 * @return true if the quality level changed, false otherwise.
+	 */
+	bool Update(float DeltaTime, double DecodeTime, int32 NumWorkers, double FramesPerSecond);
+
+private:
+
+	/** A step on the quality ladder. */
+	struct FLevel
+	{
+		/** Relative decode cost compared to the highest quality level. */
+		double Cost;
+
+		/** Number of frames to advance between decoded frames. */
+		int32 FrameStep;
+
+		/** Proxy level to decode frames at. */
+		int32 ProxyLevel;
+	};
+
+	/** Time that the decode load must exceed the available time before stepping down (in seconds). */
+	static const float OverloadDelay;
+
+	/** Time that the next higher level must fit before stepping up (in seconds). */
+	static const float UnderloadDelay;
+
+	/** Time after a switch during which no further switches happen (in seconds). */
+	static const float SettleDelay;
+
+	/** The current quality level. */
+	int32 Level;
+
+	/** The available quality levels, from highest to lowest quality. */
+	TArray<FLevel> Levels;
+
+	/** Description of the most recent switch. */
+	FString LastSwitch;
+
+	/** The most recently measured decode load. */
+	float Load;
+
+	/** Number of times the quality level changed. */
+	int32 NumSwitches;
+
+	/** Time that decoding has been falling behind (in seconds). */
+	float OverloadTime;
+
+	/** Time remaining until the current level has settled (in seconds). */
+	float SettleTime;
+
+	/** Time that the next higher level would have fit (in seconds). */
+	float UnderloadTime;
+};
@@ -0,0 +1,761 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "ExrMediaSequenceIndex.h"
+#include "ExrMediaPrivate.h"
+
+#include "Async/ParallelFor.h"
+#include "Containers/Map.h"
+#include "ExrMediaStats.h"
+#include "ExrMediaTrace.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+#include "Templates/UniquePtr.h"
+
+
+/** Magic number that identifies index sidecar files ('EXRI'). */
+static const uint32 ExrMediaIndexMagic = 0x49525845;
+
+/** Version of the index sidecar file format. */
+static const int32 ExrMediaIndexVersion = 7;
+
+/** Magic number that identifies sequence container files ('EXRP'). */
+static const uint32 ExrMediaContainerMagic = 0x50525845;
+
+/** Version of the sequence container file format. */
+static const int32 ExrMediaContainerVersion = 4;
+
+
+DECLARE_CYCLE_STAT(TEXT("Scan Directory"), STAT_ExrMedia_ScanDirectory, STATGROUP_ExrMedia);
+DECLARE_CYCLE_STAT(TEXT("Parse Headers"), STAT_ExrMedia_ParseHeaders, STATGROUP_ExrMedia);
+
+
+const TCHAR* FExrMediaSequenceIndex::ContainerExtension = TEXT("exrpak");
+const TCHAR* FExrMediaSequenceIndex::IndexFileName = TEXT(".exrindex");
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/**
+ * Find the layers of an EXR image file.
+ *
+ * @param ImagePath Path to the image file.
+ * @param OutLayers Will contain the layers, default layer first.
+ */
+static void ExrMediaFindLayers(const FString& ImagePath, TArray<FExrMediaLayer>& OutLayers)
+{
+	FMultiPartInputFile InputFile(ImagePath);
+
+	OutLayers.Empty();
+
+	if (!InputFile.IsValid())
+	{
+		return;
+	}
+
+	const FIntPoint Dim = InputFile.GetDataWindow(0);
+	const int32 NumParts = InputFile.GetNumParts();
+
+	for (int32 Part = 0; Part < NumParts; ++Part)
+	{
+		// all layers are decoded into frames of the first part's size
+		if (InputFile.GetDataWindow(Part) != Dim)
+		{
+			UE_LOG(LogExrMedia, Verbose, TEXT("Skipping part %i of %s, whose data window differs from the first part"), Part, *ImagePath);
+			continue;
+		}
+
+		// group the part's channels by the name prefix before their last dot
+		TArray<FString> PartChannelNames;
+		TMap<FString, TArray<FString>> ChannelNamesByPrefix;
+
+		InputFile.GetChannelNames(Part, PartChannelNames);
+
+		for (const FString& ChannelName : PartChannelNames)
+		{
+			int32 DotIndex = INDEX_NONE;
+			const FString Prefix = ChannelName.FindLastChar(TEXT('.'), DotIndex) ? ChannelName.Left(DotIndex) : FString();
+
+			ChannelNamesByPrefix.FindOrAdd(Prefix).Add(ChannelName);
+		}
+
+		// channels without prefix come first
+		ChannelNamesByPrefix.KeySort([](const FString& A, const FString& B) {
+			return A < B;
+		});
+
+		const FString PartName = InputFile.GetPartName(Part);
+		const FString PartLabel = (NumParts == 1) ? FString() : (PartName.IsEmpty() ? FString::Printf(TEXT("Part %i"), Part) : PartName);
+
+		for (const auto& Pair : ChannelNamesByPrefix)
+		{
+			const FString Dot = Pair.Key.IsEmpty() ? FString() : (Pair.Key + TEXT("."));
+			FExrMediaLayer Layer;
+
+			Layer.Part = Part;
+			Layer.Prefix = Pair.Key;
+
+			if (Pair.Value.Contains(Dot + TEXT("R")) && Pair.Value.Contains(Dot + TEXT("G")) && Pair.Value.Contains(Dot + TEXT("B")))
+			{
+				// color layers are decoded in RGBA order
+				Layer.ChannelNames = { Dot + TEXT("R"), Dot + TEXT("G"), Dot + TEXT("B") };
+
+				if (Pair.Value.Contains(Dot + TEXT("A")))
+				{
+					Layer.ChannelNames.Add(Dot + TEXT("A"));
+				}
+			}
+			else if ((Pair.Value.Num() <= 4) || Layer.IsDefault())
+			{
+				// the default layer is decoded through OpenEXR's RGBA conversion layer
+				Layer.ChannelNames = Pair.Value;
+			}
+			else
+			{
+				UE_LOG(LogExrMedia, Verbose, TEXT("Skipping layer %s of %s, which has %i channels but no RGB channels"), *Pair.Key, *ImagePath, Pair.Value.Num());
+				continue;
+			}
+
+			if (Pair.Key.IsEmpty())
+			{
+				Layer.Name = PartLabel.IsEmpty() ? FString(TEXT("Default")) : PartLabel;
+			}
+			else
+			{
+				Layer.Name = PartLabel.IsEmpty() ? Pair.Key : (PartLabel + TEXT(".") + Pair.Key);
+			}
+
+			OutLayers.Add(Layer);
+		}
+	}
+}
+
+
+/**
+ * Collects the EXR image files in a directory along with their file sizes and modification times.
+ */
+class FExrMediaStatVisitor
+	: public IPlatformFile::FDirectoryStatVisitor
+{
+public:
+
+	FExrMediaStatVisitor(TArray<FExrMediaFrameInfo>& InFrames, const FThreadSafeBool* InCancelled)
+		: Cancelled(InCancelled)
+		, Frames(InFrames)
+	{ }
+
+	virtual bool Visit(const TCHAR* FilenameOrDirectory, const FFileStatData& StatData) override
+	{
+		if (!StatData.bIsDirectory && (FPaths::GetExtension(FilenameOrDirectory) == TEXT("exr")))
+		{
+			FExrMediaFrameInfo& Frame = Frames[Frames.AddDefaulted()];
+			{
+				Frame.FileName = FPaths::GetCleanFilename(FilenameOrDirectory);
+				Frame.FileSize = StatData.FileSize;
+				Frame.ModificationTime = StatData.ModificationTime;
+			}
+		}
+
+		// stop iterating if the build was cancelled
+		return (Cancelled == nullptr) || !*Cancelled;
+	}
+
+private:
+
+	const FThreadSafeBool* Cancelled;
+	TArray<FExrMediaFrameInfo>& Frames;
+};
+
+
+/**
+ * Compare two file names, treating runs of digits as numbers (i.e. "F2" < "F10").
+ *
+ * @return true if A sorts before B, false otherwise.
+ */
+static bool ExrMediaNaturalLess(const FString& A, const FString& B)
+{
+	int32 IndexA = 0;
+	int32 IndexB = 0;
+
+	while ((IndexA < A.Len()) && (IndexB < B.Len()))
+	{
+		if (!FChar::IsDigit(A[IndexA]) || !FChar::IsDigit(B[IndexB]))
+		{
+			const TCHAR CharA = FChar::ToLower(A[IndexA++]);
+			const TCHAR CharB = FChar::ToLower(B[IndexB++]);
+
+			if (CharA != CharB)
+			{
+				return (CharA < CharB);
+			}
+
+			continue;
+		}
+
+		int32 EndA = IndexA;
+		int32 EndB = IndexB;
+
+		while ((EndA < A.Len()) && FChar::IsDigit(A[EndA])) ++EndA;
+		while ((EndB < B.Len()) && FChar::IsDigit(B[EndB])) ++EndB;
+
+		// without leading zeros, the number with more digits is larger
+		while ((IndexA < EndA - 1) && (A[IndexA] == TEXT('0'))) ++IndexA;
+		while ((IndexB < EndB - 1) && (B[IndexB] == TEXT('0'))) ++IndexB;
+
+		if (EndA - IndexA != EndB - IndexB)
+		{
+			return (EndA - IndexA < EndB - IndexB);
+		}
+
+		for (; IndexA < EndA; ++IndexA, ++IndexB)
+		{
+			if (A[IndexA] != B[IndexB])
+			{
+				return (A[IndexA] < B[IndexB]);
+			}
+		}
+	}
+
+	return (A.Len() - IndexA < B.Len() - IndexB);
+}
+
+
+/**
+ * Split a file name into the parts before, of and after its frame number.
+ *
+ * The frame number is the last run of digits before the file extension.
+ *
+ * @return true if the file name contains a frame number, false otherwise.
+ */
+static bool ExrMediaSplitFileName(const FString& FileName, FString& OutPrefix, FString& OutDigits, FString& OutSuffix)
+{
+	int32 End = INDEX_NONE;
+
+	if (!FileName.FindLastChar(TEXT('.'), End))
+	{
+		End = FileName.Len();
+	}
+
+	while ((End > 0) && !FChar::IsDigit(FileName[End - 1]))
+	{
+		--End;
+	}
+
+	int32 Start = End;
+
+	while ((Start > 0) && FChar::IsDigit(FileName[Start - 1]))
+	{
+		--Start;
+	}
+
+	// frame numbers must fit into an int32
+	if ((Start == End) || (End - Start > 9))
+	{
+		return false;
+	}
+
+	OutPrefix = FileName.Left(Start);
+	OutDigits = FileName.Mid(Start, End - Start);
+	OutSuffix = FileName.Mid(End);
+
+	return true;
+}
+
+
+/* FExrMediaSequenceIndex interface
+ *****************************************************************************/
+
+bool FExrMediaSequenceIndex::Build(const FString& InSequencePath, const FThreadSafeBool* Cancelled)
+{
+	SequencePath = InSequencePath;
+	ChannelNames.Empty();
+	FramePattern = FExrMediaFramePattern();
+	Frames.Empty();
+	Layers.Empty();
+	MipDims.Empty();
+	Packed = false;
+
+	// locate image sequence files
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ExrMedia_ScanDirectory);
+		EXRMEDIA_TRACE_SCOPE("Scan Directory", INDEX_NONE);
+
+		FExrMediaStatVisitor Visitor(Frames, Cancelled);
+		FPlatformFileManager::Get().GetPlatformFile().IterateDirectoryStat(*SequencePath, Visitor);
+	}
+
+	const auto IsCancelled = [Cancelled]() {
+		return (Cancelled != nullptr) && *Cancelled;
+	};
+
+	if ((Frames.Num() == 0) || IsCancelled())
+	{
+		return false;
+	}
+
+	// reuse header information of unmodified files
+	TArray<FExrMediaFrameInfo> SavedFrames;
+	TArray<FString> SavedChannelNames;
+	FExrMediaFramePattern SavedFramePattern;
+	TArray<FExrMediaLayer> SavedLayers;
+	TArray<FIntPoint> SavedMipDims;
+
+	if (Load(SavedFrames, SavedChannelNames, SavedFramePattern, SavedLayers, SavedMipDims))
+	{
+		TMap<FString, const FExrMediaFrameInfo*> SavedFramesByName;
+		SavedFramesByName.Reserve(SavedFrames.Num());
+
+		for (const FExrMediaFrameInfo& SavedFrame : SavedFrames)
+		{
+			SavedFramesByName.Add((SavedFrame.FrameNumber != INDEX_NONE) ? SavedFramePattern.GetFileName(SavedFrame.FrameNumber) : SavedFrame.FileName, &SavedFrame);
+		}
+
+		for (FExrMediaFrameInfo& Frame : Frames)
+		{
+			const FExrMediaFrameInfo* const* SavedFrame = SavedFramesByName.Find(Frame.FileName);
+
+			if ((SavedFrame != nullptr) && ((*SavedFrame)->FileSize == Frame.FileSize) && ((*SavedFrame)->ModificationTime == Frame.ModificationTime))
+			{
+				// file names are compacted again below
+				FString FileName = MoveTemp(Frame.FileName);
+
+				Frame = **SavedFrame;
+				Frame.FileName = MoveTemp(FileName);
+			}
+		}
+
+		ChannelNames = SavedChannelNames;
+		Layers = SavedLayers;
+		MipDims = SavedMipDims;
+	}
+
+	CompactFileNames();
+
+	// parse remaining headers in parallel
+	TArray<int32> StaleFrames;
+
+	for (int32 FrameIndex = 0; FrameIndex < Frames.Num(); ++FrameIndex)
+	{
+		if (Frames[FrameIndex].Dim == FIntPoint::ZeroValue)
+		{
+			StaleFrames.Add(FrameIndex);
+		}
+	}
+
+	if ((StaleFrames.Num() > 0) || (ChannelNames.Num() == 0) || (Layers.Num() == 0) || (MipDims.Num() == 0))
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ExrMedia_ParseHeaders);
+		EXRMEDIA_TRACE_SCOPE("Parse Headers", INDEX_NONE);
+
+		UE_LOG(LogExrMedia, Verbose, TEXT("Parsing %i of %i EXR image headers in %s"), StaleFrames.Num(), Frames.Num(), *SequencePath);
+
+		ParallelFor(StaleFrames.Num(), [&](int32 StaleIndex)
+		{
+			if (IsCancelled())
+			{
+				return;
+			}
+
+			FExrMediaFrameInfo& Frame = Frames[StaleFrames[StaleIndex]];
+			FRgbaInputFile InputFile(GetImagePath(StaleFrames[StaleIndex]), 0);
+
+			// frames whose header cannot be parsed keep their zero size and are dropped below
+			if (!InputFile.IsValid())
+			{
+				return;
+			}
+
+			TArray<FString> FrameChannelNames;
+
+			InputFile.GetChannelNames(FrameChannelNames);
+
+			Frame.Compression = InputFile.GetCompression();
+			Frame.Dim = InputFile.GetDataWindow();
+			Frame.FramesPerSecond = InputFile.GetFramesPerSecond(0.0);
+			Frame.HalfRgba = InputFile.HasHalfRgbaChannels();
+			Frame.LinesPerBlock = InputFile.GetLinesPerBlock();
+			Frame.NumChannels = FrameChannelNames.Num();
+			Frame.NumMipLevels = InputFile.GetNumMipLevels();
+		});
+
+		// a partially parsed index must not be saved
+		if (IsCancelled())
+		{
+			return false;
+		}
+
+		for (int32 StaleIndex = StaleFrames.Num() - 1; StaleIndex >= 0; --StaleIndex)
+		{
+			if (Frames[StaleFrames[StaleIndex]].Dim == FIntPoint::ZeroValue)
+			{
+				UE_LOG(LogExrMedia, Warning, TEXT("Skipping %s, which is not a valid EXR image"), *GetImagePath(StaleFrames[StaleIndex]));
+				Frames.RemoveAt(StaleFrames[StaleIndex]);
+			}
+		}
+
+		if (Frames.Num() == 0)
+		{
+			return false;
+		}
+
+		FRgbaInputFile FirstFile(GetImagePath(0), 0);
+		ChannelNames.Empty();
+		MipDims.Empty();
+
+		if (FirstFile.IsValid())
+		{
+			FirstFile.GetChannelNames(ChannelNames);
+
+			for (int32 MipLevel = 0; MipLevel < FirstFile.GetNumMipLevels(); ++MipLevel)
+			{
+				MipDims.Add(FirstFile.GetMipDataWindow(MipLevel));
+			}
+		}
+
+		ExrMediaFindLayers(GetImagePath(0), Layers);
+
+		Save();
+	}
+
+	return true;
+}
+
+
+bool FExrMediaSequenceIndex::BuildFromContainer(const FString& InContainerPath)
+{
+	SequencePath = InContainerPath;
+	ChannelNames.Empty();
+	FramePattern = FExrMediaFramePattern();
+	Frames.Empty();
+	Layers.Empty();
+	MipDims.Empty();
+	Packed = true;
+
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*SequencePath, FILEREAD_Silent));
+
+	if (!Reader.IsValid())
+	{
+		return false;
+	}
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+
+	*Reader << Magic << Version;
+
+	if ((Magic != ExrMediaContainerMagic) || (Version != ExrMediaContainerVersion))
+	{
+		UE_LOG(LogExrMedia, Warning, TEXT("%s is not a supported EXR sequence container"), *SequencePath);
+		return false;
+	}
+
+	*Reader << ChannelNames << FramePattern << Layers << MipDims << Frames;
+
+	return !Reader->IsError() && (Frames.Num() > 0);
+}
+
+
+int32 FExrMediaSequenceIndex::GetGaps(TArray<FInt32Interval>& OutGaps) const
+{
+	OutGaps.Empty();
+
+	int32 NumMissingFrames = 0;
+
+	for (int32 FrameIndex = 1; FrameIndex < Frames.Num(); ++FrameIndex)
+	{
+		const int32 PreviousNumber = Frames[FrameIndex - 1].FrameNumber;
+		const int32 Number = Frames[FrameIndex].FrameNumber;
+
+		// frames without a frame number follow all numbered frames
+		if (Number == INDEX_NONE)
+		{
+			break;
+		}
+
+		if (Number > PreviousNumber + 1)
+		{
+			OutGaps.Add(FInt32Interval(PreviousNumber + 1, Number - 1));
+			NumMissingFrames += Number - PreviousNumber - 1;
+		}
+	}
+
+	return NumMissingFrames;
+}
+
+
+FString FExrMediaSequenceIndex::GetImagePath(int32 FrameIndex) const
+{
+	const FExrMediaFrameInfo& Frame = Frames[FrameIndex];
+
+	if (Frame.FrameNumber != INDEX_NONE)
+	{
+		return FPaths::Combine(*SequencePath, *FramePattern.GetFileName(Frame.FrameNumber));
+	}
+
+	return FPaths::Combine(*SequencePath, *Frame.FileName);
+}
+
+
+int32 FExrMediaSequenceIndex::GetNumMismatchedFrames() const
+{
+	int32 NumMismatchedFrames = 0;
+
+	for (const FExrMediaFrameInfo& Frame : Frames)
+	{
+		if (Frame.Dim != Frames[0].Dim)
+		{
+			++NumMismatchedFrames;
+		}
+	}
+
+	return NumMismatchedFrames;
+}
+
+
+int32 FExrMediaSequenceIndex::GetNumMipLevels() const
+{
+	int32 NumMipLevels = MAX_int32;
+
+	for (const FExrMediaFrameInfo& Frame : Frames)
+	{
+		NumMipLevels = FMath::Min(NumMipLevels, Frame.NumMipLevels);
+	}
+
+	return (Frames.Num() > 0) ? NumMipLevels : 1;
+}
+
+
+bool FExrMediaSequenceIndex::HasUniformChannels() const
+{
+	for (const FExrMediaFrameInfo& Frame : Frames)
+	{
+		if (Frame.NumChannels != ChannelNames.Num())
+		{
+			return false;
+		}
+	}
+
+	return (Frames.Num() > 0);
+}
+
+
+bool FExrMediaSequenceIndex::IsHalfRgba() const
+{
+	for (const FExrMediaFrameInfo& Frame : Frames)
+	{
+		if (!Frame.HalfRgba)
+		{
+			return false;
+		}
+	}
+
+	return (Frames.Num() > 0);
+}
+
+
+bool FExrMediaSequenceIndex::SaveContainer(const FString& ContainerPath) const
+{
+	if (Packed || (Frames.Num() == 0))
+	{
+		return false;
+	}
+
+	// the frame table is serialized twice, once to measure it and
+	// once with the final offsets; offsets are fixed size integers
+	uint32 Magic = ExrMediaContainerMagic;
+	int32 Version = ExrMediaContainerVersion;
+	TArray<FString> ContainerChannelNames = ChannelNames;
+	FExrMediaFramePattern ContainerFramePattern = FramePattern;
+	TArray<FExrMediaFrameInfo> ContainerFrames = Frames;
+	TArray<FExrMediaLayer> ContainerLayers = Layers;
+	TArray<FIntPoint> ContainerMipDims = MipDims;
+
+	TArray<uint8> Table;
+	FMemoryWriter TableWriter(Table);
+	TableWriter << Magic << Version << ContainerChannelNames << ContainerFramePattern << ContainerLayers << ContainerMipDims << ContainerFrames;
+
+	int64 Offset = Table.Num();
+
+	for (FExrMediaFrameInfo& Frame : ContainerFrames)
+	{
+		Frame.Offset = Offset;
+		Offset += Frame.FileSize;
+	}
+
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*ContainerPath));
+
+	if (!Writer.IsValid())
+	{
+		UE_LOG(LogExrMedia, Error, TEXT("Failed to create sequence container %s"), *ContainerPath);
+		return false;
+	}
+
+	*Writer << Magic << Version << ContainerChannelNames << ContainerFramePattern << ContainerLayers << ContainerMipDims << ContainerFrames;
+	check(Writer->Tell() == Table.Num());
+
+	// append image files
+	TArray<uint8> ImageData;
+
+	for (int32 FrameIndex = 0; FrameIndex < Frames.Num(); ++FrameIndex)
+	{
+		if (!FFileHelper::LoadFileToArray(ImageData, *GetImagePath(FrameIndex)) || (ImageData.Num() != Frames[FrameIndex].FileSize))
+		{
+			UE_LOG(LogExrMedia, Error, TEXT("Image file %s changed while packing sequence container %s"), *GetImagePath(FrameIndex), *ContainerPath);
+			Writer->Close();
+			IFileManager::Get().Delete(*ContainerPath);
+
+			return false;
+		}
+
+		Writer->Serialize(ImageData.GetData(), ImageData.Num());
+	}
+
+	return Writer->Close();
+}
+
+
+/* FExrMediaSequenceIndex implementation
+ *****************************************************************************/
+
+void FExrMediaSequenceIndex::CompactFileNames()
+{
+	TArray<FString> Prefixes, Digits, Suffixes;
+
+	Prefixes.SetNum(Frames.Num());
+	Digits.SetNum(Frames.Num());
+	Suffixes.SetNum(Frames.Num());
+
+	// the most common prefix and suffix form the pattern
+	TMap<FString, int32> PatternCounts;
+
+	for (int32 FrameIndex = 0; FrameIndex < Frames.Num(); ++FrameIndex)
+	{
+		Frames[FrameIndex].FrameNumber = INDEX_NONE;
+
+		if (ExrMediaSplitFileName(Frames[FrameIndex].FileName, Prefixes[FrameIndex], Digits[FrameIndex], Suffixes[FrameIndex]))
+		{
+			// slashes cannot occur in file names
+			++PatternCounts.FindOrAdd(Prefixes[FrameIndex] + TEXT("/") + Suffixes[FrameIndex]);
+		}
+	}
+
+	FString PatternKey;
+	int32 PatternCount = 0;
+
+	for (const auto& Pair : PatternCounts)
+	{
+		if (Pair.Value > PatternCount)
+		{
+			PatternKey = Pair.Key;
+			PatternCount = Pair.Value;
+		}
+	}
+
+	FramePattern = FExrMediaFramePattern();
+
+	if (PatternCount > 0)
+	{
+		PatternKey.Split(TEXT("/"), &FramePattern.Prefix, &FramePattern.Suffix);
+
+		// padded frame numbers have leading zeros, while numbers without
+		// leading zeros can be rebuilt with any padding up to their length
+		int32 PaddedLength = 0;
+		int32 MinLength = MAX_int32;
+
+		for (int32 FrameIndex = 0; FrameIndex < Frames.Num(); ++FrameIndex)
+		{
+			if (Digits[FrameIndex].IsEmpty() || (Prefixes[FrameIndex] != FramePattern.Prefix) || (Suffixes[FrameIndex] != FramePattern.Suffix))
+			{
+				continue;
+			}
+
+			if ((Digits[FrameIndex].Len() > 1) && (Digits[FrameIndex][0] == TEXT('0')))
+			{
+				PaddedLength = (PaddedLength > 0) ? PaddedLength : Digits[FrameIndex].Len();
+			}
+			else
+			{
+				MinLength = FMath::Min(MinLength, Digits[FrameIndex].Len());
+			}
+		}
+
+		FramePattern.Padding = (PaddedLength > 0) ? PaddedLength : MinLength;
+
+		// keep the names of files that the pattern cannot rebuild
+		for (int32 FrameIndex = 0; FrameIndex < Frames.Num(); ++FrameIndex)
+		{
+			FExrMediaFrameInfo& Frame = Frames[FrameIndex];
+
+			if (!Digits[FrameIndex].IsEmpty())
+			{
+				const int32 FrameNumber = FCString::Atoi(*Digits[FrameIndex]);
+
+				if (FramePattern.GetFileName(FrameNumber) == Frame.FileName)
+				{
+					Frame.FileName.Empty();
+					Frame.FrameNumber = FrameNumber;
+				}
+			}
+		}
+	}
+
+	Frames.Sort([](const FExrMediaFrameInfo& A, const FExrMediaFrameInfo& B) {
+		if ((A.FrameNumber == INDEX_NONE) || (B.FrameNumber == INDEX_NONE))
+		{
+			return (A.FrameNumber != INDEX_NONE) || ((B.FrameNumber == INDEX_NONE) && ExrMediaNaturalLess(A.FileName, B.FileName));
+		}
+
+		return (A.FrameNumber < B.FrameNumber);
+	});
+}
+
+
+bool FExrMediaSequenceIndex::Load(TArray<FExrMediaFrameInfo>& OutFrames, TArray<FString>& OutChannelNames, FExrMediaFramePattern& OutFramePattern, TArray<FExrMediaLayer>& OutLayers, TArray<FIntPoint>& OutMipDims) const
+{
+	const FString IndexPath = FPaths::Combine(*SequencePath, IndexFileName);
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*IndexPath, FILEREAD_Silent));
+
+	if (!Reader.IsValid())
+	{
+		return false;
+	}
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+
+	*Reader << Magic << Version;
+
+	if ((Magic != ExrMediaIndexMagic) || (Version != ExrMediaIndexVersion))
+	{
+		UE_LOG(LogExrMedia, Verbose, TEXT("Ignoring outdated sequence index %s"), *IndexPath);
+		return false;
+	}
+
+	*Reader << OutChannelNames << OutFramePattern << OutLayers << OutMipDims << OutFrames;
+
+	return !Reader->IsError();
+}
+
+
+bool FExrMediaSequenceIndex::Save()
+{
+	const FString IndexPath = FPaths::Combine(*SequencePath, IndexFileName);
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*IndexPath, FILEWRITE_Silent));
+
+	if (!Writer.IsValid())
+	{
+		UE_LOG(LogExrMedia, Verbose, TEXT("Failed to write sequence index %s"), *IndexPath);
+		return false;
+	}
+
+	uint32 Magic = ExrMediaIndexMagic;
+	int32 Version = ExrMediaIndexVersion;
+
+	*Writer << Magic << Version << ChannelNames << FramePattern << Layers << MipDims << Frames;
+
+	return Writer->Close();
+}
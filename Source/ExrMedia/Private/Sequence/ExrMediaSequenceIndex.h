@@ -0,0 +1,424 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "Containers/UnrealString.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Math/Interval.h"
+#include "Math/IntPoint.h"
+#include "Misc/DateTime.h"
+#include "OpenExrWrapper.h"
+#include "Serialization/Archive.h"
+
+
+/**
+ * Describes how the image file names of a sequence are built from frame numbers.
+ *
+ * A file name consists of a prefix, the frame number zero padded to a minimum
+ * number of digits, and a suffix, i.e. "Shot_" + "0042" + ".exr".
+ */
+struct FExrMediaFramePattern
+{
+	/** Minimum number of digits of the frame number (0 = not padded). */
+	int32 Padding;
+
+	/** The part of the file name before the frame number. */
+	FString Prefix;
+
+	/** The part of the file name after the frame number, including the extension. */
+	FString Suffix;
+
+	/** Default constructor. */
+	FExrMediaFramePattern()
+		: Padding(0)
+	{ }
+
+	/**
+	 * Build the file name of the specified frame number.
+	 *
+	 * @param FrameNumber The frame number.
+	 * @return File name (without path).
+	 */
+	FString GetFileName(int32 FrameNumber) const
+	{
+		const FString Digits = FString::FromInt(FrameNumber);
+
+		return (Digits.Len() < Padding)
+			? Prefix + FString::ChrN(Padding - Digits.Len(), TEXT('0')) + Digits + Suffix
+			: Prefix + Digits + Suffix;
+	}
+
+	/** Serialize the specified frame pattern from or into an archive. */
+	friend FArchive& operator<<(FArchive& Ar, FExrMediaFramePattern& Pattern)
+	{
+		return Ar << Pattern.Padding << Pattern.Prefix << Pattern.Suffix;
+	}
+};
+
+
+/**
+ * A layer of the images in an EXR image sequence, which is played as a video track.
+ *
+ * Layers are the parts of multi-part images, and the groups of channels within a
+ * part that share a name prefix (i.e. "diffuse.R", "diffuse.G" and "diffuse.B").
+ */
+struct FExrMediaLayer
+{
+	/** Names of the layer's channels in decode order (R, G, B and A for color layers). */
+	TArray<FString> ChannelNames;
+
+	/** Display name of the layer. */
+	FString Name;
+
+	/** Index of the image part that holds the layer. */
+	int32 Part;
+
+	/** The name prefix of the layer's channels, without the trailing dot (empty = channels without prefix). */
+	FString Prefix;
+
+	/** Default constructor. */
+	FExrMediaLayer()
+		: Part(0)
+	{ }
+
+	/**
+	 * Check whether this is the default layer, which holds the channels without prefix in the first part.
+	 *
+	 * @return true if this is the default layer, false otherwise.
+	 */
+	bool IsDefault() const
+	{
+		return (Part == 0) && Prefix.IsEmpty();
+	}
+
+	/** Serialize the specified layer from or into an archive. */
+	friend FArchive& operator<<(FArchive& Ar, FExrMediaLayer& Layer)
+	{
+		return Ar << Layer.ChannelNames << Layer.Name << Layer.Part << Layer.Prefix;
+	}
+};
+
+
+/**
+ * Header information for a single frame of an EXR image sequence.
+ */
+struct FExrMediaFrameInfo
+{
+	/** Compression method of the image file. */
+	EExrCompression Compression;
+
+	/** Width and height of the image's data window (in pixels). */
+	FIntPoint Dim;
+
+	/** Name of the image file (without path) if it does not match the sequence's frame pattern, empty otherwise. */
+	FString FileName;
+
+	/** Number of the frame in the sequence's frame pattern (INDEX_NONE = file name does not match). */
+	int32 FrameNumber;
+
+	/** Size of the image file (in bytes). */
+	int64 FileSize;
+
+	/** Frame rate stored in the image header (0.0 = not specified). */
+	double FramesPerSecond;
+
+	/** Whether the image has full resolution half-float R, G, B and optional A channels only. */
+	bool HalfRgba;
+
+	/** Number of scan lines per compressed line block. */
+	int32 LinesPerBlock;
+
+	/** Time that the image file was last modified. */
+	FDateTime ModificationTime;
+
+	/** Number of channels in the image. */
+	int32 NumChannels;
+
+	/** Number of mip levels in the image (1 = scan line image or single level tiled image). */
+	int32 NumMipLevels;
+
+	/** Offset of the image data in the sequence container file (0 = loose image file). */
+	int64 Offset;
+
+	/** Default constructor. */
+	FExrMediaFrameInfo()
+		: Compression(EExrCompression::Unknown)
+		, Dim(FIntPoint::ZeroValue)
+		, FrameNumber(INDEX_NONE)
+		, FileSize(0)
+		, FramesPerSecond(0.0)
+		, HalfRgba(false)
+		, LinesPerBlock(1)
+		, NumChannels(0)
+		, NumMipLevels(1)
+		, Offset(0)
+	{ }
+
+	/** Serialize the specified frame info from or into an archive. */
+	friend FArchive& operator<<(FArchive& Ar, FExrMediaFrameInfo& Info)
+	{
+		uint8 Compression = (uint8)Info.Compression;
+
+		Ar << Compression << Info.Dim << Info.FileName << Info.FileSize << Info.FrameNumber << Info.FramesPerSecond
+			<< Info.HalfRgba << Info.LinesPerBlock << Info.ModificationTime << Info.NumChannels << Info.NumMipLevels << Info.Offset;
+
+		Info.Compression = (EExrCompression)Compression;
+
+		return Ar;
+	}
+};
+
+
+/**
+ * Holds the header information of all frames in an EXR image sequence.
+ *
+ * Frames are identified by their number in the sequence's file name pattern
+ * rather than by file name, so that long sequences do not hold a string per
+ * frame. Frames are ordered by frame number; files whose names do not match
+ * the pattern keep their file name and follow in natural order.
+ *
+ * Parsing the headers of a long sequence is expensive, so the index is stored
+ * in a sidecar file in the sequence directory. Entries in the sidecar file are
+ * reused as long as the size and modification time of their image files did
+ * not change; only new or modified files are parsed, in parallel.
+ *
+ * Sequences can also be packed into a single container file, which starts with
+ * the index, followed by the frames' image files. The frames of a container are
+ * read by offset, so that playback neither enumerates a directory nor opens a
+ * file per frame.
+ */
+class FExrMediaSequenceIndex
+{
+public:
+
+	/** Default constructor. */
+	FExrMediaSequenceIndex()
+		: Packed(false)
+	{ }
+
+public:
+
+	/**
+	 * Build the index for the EXR image files in the specified directory.
+	 *
+	 * The index may be built on any thread. The build can be cancelled from
+	 * another thread, in which case it stops scanning and parsing as soon as
+	 * possible and does not update the sidecar file.
+	 *
+	 * @param InSequencePath Path to the image sequence directory.
+	 * @param Cancelled Optional flag that is set when the build is to be cancelled.
+	 * @return true on success, false if the directory contains no EXR images or the build was cancelled.
+	 */
+	bool Build(const FString& InSequencePath, const FThreadSafeBool* Cancelled = nullptr);
+
+	/**
+	 * Load the index of a sequence container file.
+	 *
+	 * @param InContainerPath Path to the sequence container file.
+	 * @return true on success, false if the file is not a valid sequence container.
+	 * @see SaveContainer
+	 */
+	bool BuildFromContainer(const FString& InContainerPath);
+
+	/**
+	 * Get the names of the channels in the sequence's first frame.
+	 *
+	 * @return Channel names.
+	 */
+	const TArray<FString>& GetChannelNames() const
+	{
+		return ChannelNames;
+	}
+
+	/**
+	 * Get the header information of the specified frame.
+	 *
+	 * @param FrameIndex Index of the frame.
+	 * @return Frame information.
+	 */
+	const FExrMediaFrameInfo& GetFrameInfo(int32 FrameIndex) const
+	{
+		return Frames[FrameIndex];
+	}
+
+	/**
+	 * Get the file name pattern of the sequence's frames.
+	 *
+	 * @return Frame pattern.
+	 */
+	const FExrMediaFramePattern& GetFramePattern() const
+	{
+		return FramePattern;
+	}
+
+	/**
+	 * Get the ranges of frame numbers that are missing between the first and last frame.
+	 *
+	 * @param OutGaps Will contain the first and last missing frame number of each gap.
+	 * @return Total number of missing frames.
+	 */
+	int32 GetGaps(TArray<FInt32Interval>& OutGaps) const;
+
+	/**
+	 * Get the layers of the sequence's first frame.
+	 *
+	 * The default layer, if the images have one, comes first.
+	 *
+	 * @return Layers.
+	 */
+	const TArray<FExrMediaLayer>& GetLayers() const
+	{
+		return Layers;
+	}
+
+	/**
+	 * Get the path to the specified frame's image file.
+	 *
+	 * @param FrameIndex Index of the frame.
+	 * @return Image file path.
+	 */
+	FString GetImagePath(int32 FrameIndex) const;
+
+	/**
+	 * Get the dimensions of the specified mip level of the sequence's first frame.
+	 *
+	 * @param MipLevel The mip level (0 = full resolution).
+	 * @return Mip level dimensions, or the frame's dimensions if the level does not exist.
+	 */
+	FIntPoint GetMipDim(int32 MipLevel) const
+	{
+		return MipDims.IsValidIndex(MipLevel) ? MipDims[MipLevel] : Frames[0].Dim;
+	}
+
+	/**
+	 * Get the number of frames whose dimensions differ from the first frame.
+	 *
+	 * @return Number of mismatched frames.
+	 */
+	int32 GetNumMismatchedFrames() const;
+
+	/**
+	 * Check whether all frames have as many channels as the first frame.
+	 *
+	 * @return true if the channel count is uniform, false otherwise.
+	 */
+	bool HasUniformChannels() const;
+
+	/**
+	 * Check whether all frames have full resolution half-float RGB(A) channels only.
+	 *
+	 * Such sequences can be decoded straight into the frame buffer
+	 * without going through OpenEXR's RGBA conversion layer.
+	 *
+	 * @return true if all frames are half-float RGB(A), false otherwise.
+	 */
+	bool IsHalfRgba() const;
+
+	/**
+	 * Get the number of mip levels that all frames in the sequence have.
+	 *
+	 * @return Number of mip levels (1 = no mip levels).
+	 */
+	int32 GetNumMipLevels() const;
+
+	/**
+	 * Get the number of frames in the sequence.
+	 *
+	 * @return Number of frames.
+	 */
+	int32 GetNumFrames() const
+	{
+		return Frames.Num();
+	}
+
+	/**
+	 * Check whether the sequence is stored in a sequence container file.
+	 *
+	 * @return true if the sequence is packed, false if it consists of loose image files.
+	 */
+	bool IsPacked() const
+	{
+		return Packed;
+	}
+
+	/**
+	 * Pack the sequence's image files into a single sequence container file.
+	 *
+	 * @param ContainerPath Path to the container file to write.
+	 * @return true on success, false otherwise.
+	 * @see BuildFromContainer
+	 */
+	bool SaveContainer(const FString& ContainerPath) const;
+
+	/**
+	 * Get the path to the image sequence directory, or the sequence container file if packed.
+	 *
+	 * @return Sequence path.
+	 */
+	const FString& GetSequencePath() const
+	{
+		return SequencePath;
+	}
+
+public:
+
+	/** File extension of sequence container files. */
+	static const TCHAR* ContainerExtension;
+
+	/** Name of the sidecar file that stores the index in the sequence directory. */
+	static const TCHAR* IndexFileName;
+
+protected:
+
+	/**
+	 * Load a previously saved index from the sidecar file.
+	 *
+	 * @param OutFrames Will contain the frames stored in the sidecar file.
+	 * @param OutChannelNames Will contain the channel names stored in the sidecar file.
+	 * @param OutFramePattern Will contain the frame pattern stored in the sidecar file.
+	 * @param OutLayers Will contain the layers stored in the sidecar file.
+	 * @param OutMipDims Will contain the mip level dimensions stored in the sidecar file.
+	 * @return true if the sidecar file was loaded, false otherwise.
+	 */
+	bool Load(TArray<FExrMediaFrameInfo>& OutFrames, TArray<FString>& OutChannelNames, FExrMediaFramePattern& OutFramePattern, TArray<FExrMediaLayer>& OutLayers, TArray<FIntPoint>& OutMipDims) const;
+
+	/**
+	 * Replace the frames' file names by frame numbers, and sort the frames.
+	 *
+	 * The most common file name pattern is detected from the frames' file names.
+	 * Frames whose file names cannot be rebuilt from the pattern keep their names.
+	 */
+	void CompactFileNames();
+
+	/**
+	 * Save the index to the sidecar file.
+	 *
+	 * @return true on success, false otherwise.
+	 */
+	bool Save();
+
+private:
+
+	/** Names of the channels in the sequence's first frame. */
+	TArray<FString> ChannelNames;
+
+	/** The file name pattern of the sequence's frames. */
+	FExrMediaFramePattern FramePattern;
+
+	/** Header information for each frame, sorted by frame number. */
+	TArray<FExrMediaFrameInfo> Frames;
+
+	/** The layers of the sequence's first frame. */
+	TArray<FExrMediaLayer> Layers;
+
+	/** Dimensions of the mip levels of the sequence's first frame, so that proxy resolutions can be resolved without opening it. */
+	TArray<FIntPoint> MipDims;
+
+	/** Whether the sequence is stored in a sequence container file. */
+	bool Packed;
+
+	/** Path to the image sequence directory, or the sequence container file if packed. */
+	FString SequencePath;
+};
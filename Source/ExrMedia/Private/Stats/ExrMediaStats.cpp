@@ -0,0 +1,249 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "ExrMediaStats.h"
+#include "ExrMediaPrivate.h"
+
+#include "HAL/PlatformTime.h"
+#include "Misc/ScopeLock.h"
+#include "Templates/Sorting.h"
+
+
+DEFINE_STAT(STAT_ExrMedia_FramesDecoded);
+DEFINE_STAT(STAT_ExrMedia_FramesDropped);
+DEFINE_STAT(STAT_ExrMedia_FramesRepeated);
+DEFINE_STAT(STAT_ExrMedia_OpenTime);
+DEFINE_STAT(STAT_ExrMedia_HeaderTime);
+DEFINE_STAT(STAT_ExrMedia_DecompressTime);
+DEFINE_STAT(STAT_ExrMedia_ConvertTime);
+DEFINE_STAT(STAT_ExrMedia_CopyTime);
+DEFINE_STAT(STAT_ExrMedia_ReadRate);
+DEFINE_STAT(STAT_ExrMedia_SeekLatency);
+DEFINE_STAT(STAT_ExrMedia_CachedFrames);
+DEFINE_STAT(STAT_ExrMedia_PrefetchedFrames);
+DEFINE_STAT(STAT_ExrMedia_FrameMemory);
+
+
+/** Length of the period over which the read rate is measured (in seconds). */
+static const double ExrMediaReadRatePeriod = 1.0;
+
+
+/* FExrMediaRollingTime interface
+ *****************************************************************************/
+
+void FExrMediaRollingTime::Add(double Seconds)
+{
+	Samples[NextSample] = (float)Seconds;
+	NextSample = (NextSample + 1) % WindowSize;
+	NumSamples = FMath::Min(NumSamples + 1, WindowSize);
+}
+
+
+double FExrMediaRollingTime::GetAverage() const
+{
+	if (NumSamples == 0)
+	{
+		return 0.0;
+	}
+
+	double Sum = 0.0;
+
+	for (int32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+	{
+		Sum += Samples[SampleIndex];
+	}
+
+	return Sum / NumSamples;
+}
+
+
+double FExrMediaRollingTime::GetMin() const
+{
+	if (NumSamples == 0)
+	{
+		return 0.0;
+	}
+
+	float Min = Samples[0];
+
+	for (int32 SampleIndex = 1; SampleIndex < NumSamples; ++SampleIndex)
+	{
+		Min = FMath::Min(Min, Samples[SampleIndex]);
+	}
+
+	return Min;
+}
+
+
+double FExrMediaRollingTime::GetPercentile(float Fraction) const
+{
+	if (NumSamples == 0)
+	{
+		return 0.0;
+	}
+
+	float Sorted[WindowSize];
+	FMemory::Memcpy(Sorted, Samples, NumSamples * sizeof(float));
+	Sort(Sorted, NumSamples);
+
+	return Sorted[FMath::Clamp(FMath::CeilToInt(Fraction * NumSamples) - 1, 0, NumSamples - 1)];
+}
+
+
+FString FExrMediaRollingTime::ToString() const
+{
+	return FString::Printf(TEXT("%.2f / %.2f / %.2f ms"), GetMin() * 1000.0, GetAverage() * 1000.0, GetPercentile(0.99f) * 1000.0);
+}
+
+
+/* FExrMediaPlaybackStats structors
+ *****************************************************************************/
+
+FExrMediaPlaybackStats::FExrMediaPlaybackStats()
+{
+	Reset();
+}
+
+
+/* FExrMediaPlaybackStats interface
+ *****************************************************************************/
+
+void FExrMediaPlaybackStats::AddDecodedFrame(const FExrMediaDecodeTimings& Timings)
+{
+	INC_DWORD_STAT(STAT_ExrMedia_FramesDecoded);
+
+	FScopeLock Lock(&CriticalSection);
+
+	ConvertTime.Add(Timings.ConvertTime);
+	DecompressTime.Add(Timings.DecompressTime);
+	HeaderTime.Add(Timings.HeaderTime);
+	OpenTime.Add(Timings.OpenTime);
+
+	++NumDecodedFrames;
+
+	// the read rate is measured over fixed periods
+	const double Now = FPlatformTime::Seconds();
+
+	ReadRateBytes += Timings.BytesRead;
+
+	if (Now - ReadRateStartTime >= ExrMediaReadRatePeriod)
+	{
+		ReadRate = ReadRateBytes / (Now - ReadRateStartTime);
+		ReadRateBytes = 0;
+		ReadRateStartTime = Now;
+	}
+}
+
+
+void FExrMediaPlaybackStats::AddCopyTime(double Seconds)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	CopyTime.Add(Seconds);
+}
+
+
+void FExrMediaPlaybackStats::AddDroppedFrames(int32 NumFrames)
+{
+	INC_DWORD_STAT_BY(STAT_ExrMedia_FramesDropped, NumFrames);
+
+	FScopeLock Lock(&CriticalSection);
+
+	NumDroppedFrames += NumFrames;
+}
+
+
+void FExrMediaPlaybackStats::AddRepeatedFrame()
+{
+	INC_DWORD_STAT(STAT_ExrMedia_FramesRepeated);
+
+	FScopeLock Lock(&CriticalSection);
+
+	++NumRepeatedFrames;
+}
+
+
+void FExrMediaPlaybackStats::AddSeekLatency(double Seconds)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	SeekLatency.Add(Seconds);
+	++NumSeeks;
+}
+
+
+void FExrMediaPlaybackStats::PublishStats(int32 NumCachedFrames, int32 NumPrefetchedFrames) const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	SET_FLOAT_STAT(STAT_ExrMedia_OpenTime, OpenTime.GetAverage() * 1000.0);
+	SET_FLOAT_STAT(STAT_ExrMedia_HeaderTime, HeaderTime.GetAverage() * 1000.0);
+	SET_FLOAT_STAT(STAT_ExrMedia_DecompressTime, DecompressTime.GetAverage() * 1000.0);
+	SET_FLOAT_STAT(STAT_ExrMedia_ConvertTime, ConvertTime.GetAverage() * 1000.0);
+	SET_FLOAT_STAT(STAT_ExrMedia_CopyTime, CopyTime.GetAverage() * 1000.0);
+	SET_FLOAT_STAT(STAT_ExrMedia_ReadRate, GetReadRate() / (1024.0 * 1024.0));
+	SET_FLOAT_STAT(STAT_ExrMedia_SeekLatency, SeekLatency.GetAverage() * 1000.0);
+	SET_DWORD_STAT(STAT_ExrMedia_CachedFrames, NumCachedFrames);
+	SET_DWORD_STAT(STAT_ExrMedia_PrefetchedFrames, NumPrefetchedFrames);
+}
+
+
+void FExrMediaPlaybackStats::Reset()
+{
+	FScopeLock Lock(&CriticalSection);
+
+	ConvertTime = FExrMediaRollingTime();
+	CopyTime = FExrMediaRollingTime();
+	DecompressTime = FExrMediaRollingTime();
+	HeaderTime = FExrMediaRollingTime();
+	NumDecodedFrames = 0;
+	NumDroppedFrames = 0;
+	NumRepeatedFrames = 0;
+	NumSeeks = 0;
+	OpenTime = FExrMediaRollingTime();
+	ReadRate = 0.0;
+	ReadRateBytes = 0;
+	ReadRateStartTime = FPlatformTime::Seconds();
+	SeekLatency = FExrMediaRollingTime();
+}
+
+
+FString FExrMediaPlaybackStats::ToString() const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	FString StatsString;
+	{
+		StatsString += TEXT("Playback\n");
+		StatsString += FString::Printf(TEXT("    Frames Decoded: %llu\n"), NumDecodedFrames);
+		StatsString += FString::Printf(TEXT("    Frames Dropped: %llu\n"), NumDroppedFrames);
+		StatsString += FString::Printf(TEXT("    Frames Repeated: %llu\n"), NumRepeatedFrames);
+		StatsString += FString::Printf(TEXT("    Seeks: %llu\n"), NumSeeks);
+		StatsString += FString::Printf(TEXT("    Read Rate: %.1f MB/s\n"), GetReadRate() / (1024.0 * 1024.0));
+		StatsString += TEXT("Timings (min / avg / p99)\n");
+		StatsString += FString::Printf(TEXT("    Open: %s\n"), *OpenTime.ToString());
+		StatsString += FString::Printf(TEXT("    Header: %s\n"), *HeaderTime.ToString());
+		StatsString += FString::Printf(TEXT("    Decompress: %s\n"), *DecompressTime.ToString());
+		StatsString += FString::Printf(TEXT("    Convert: %s\n"), *ConvertTime.ToString());
+		StatsString += FString::Printf(TEXT("    Copy To Sink: %s\n"), *CopyTime.ToString());
+		StatsString += FString::Printf(TEXT("    Seek To First Pixel: %s\n"), *SeekLatency.ToString());
+	}
+
+	return StatsString;
+}
+
+
+/* FExrMediaPlaybackStats implementation
+ *****************************************************************************/
+
+double FExrMediaPlaybackStats::GetReadRate() const
+{
+	// the rate drops to zero once decoding stops
+	const double Elapsed = FPlatformTime::Seconds() - ReadRateStartTime;
+
+	if (Elapsed >= 2.0 * ExrMediaReadRatePeriod)
+	{
+		return 0.0;
+	}
+
+	return ReadRate;
+}
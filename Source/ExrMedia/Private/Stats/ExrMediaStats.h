@@ -0,0 +1,252 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/UnrealString.h"
+#include "HAL/CriticalSection.h"
+#include "Stats/Stats.h"
+
+
+DECLARE_STATS_GROUP(TEXT("ExrMedia"), STATGROUP_ExrMedia, STATCAT_Advanced);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Frames Decoded"), STAT_ExrMedia_FramesDecoded, STATGROUP_ExrMedia, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Frames Dropped"), STAT_ExrMedia_FramesDropped, STATGROUP_ExrMedia, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Frames Repeated"), STAT_ExrMedia_FramesRepeated, STATGROUP_ExrMedia, );
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Open Time (ms)"), STAT_ExrMedia_OpenTime, STATGROUP_ExrMedia, );
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Header Time (ms)"), STAT_ExrMedia_HeaderTime, STATGROUP_ExrMedia, );
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Decompress Time (ms)"), STAT_ExrMedia_DecompressTime, STATGROUP_ExrMedia, );
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Convert Time (ms)"), STAT_ExrMedia_ConvertTime, STATGROUP_ExrMedia, );
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Copy Time (ms)"), STAT_ExrMedia_CopyTime, STATGROUP_ExrMedia, );
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Read Rate (MB/s)"), STAT_ExrMedia_ReadRate, STATGROUP_ExrMedia, );
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Seek Latency (ms)"), STAT_ExrMedia_SeekLatency, STATGROUP_ExrMedia, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Cached Frames"), STAT_ExrMedia_CachedFrames, STATGROUP_ExrMedia, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Prefetched Frames"), STAT_ExrMedia_PrefetchedFrames, STATGROUP_ExrMedia, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Frame Memory"), STAT_ExrMedia_FrameMemory, STATGROUP_ExrMedia, );
+
+
+/**
+ * Time spent in each stage of decoding a single frame.
+ */
+struct FExrMediaDecodeTimings
+{
+	/** Number of bytes of image data that the frame was decoded from. */
+	int64 BytesRead;
+
+	/** Time spent converting the decoded pixels to the output format (in seconds). */
+	double ConvertTime;
+
+	/** Time spent decompressing and reading pixels (in seconds). */
+	double DecompressTime;
+
+	/** Time spent parsing the image header (in seconds; includes opening the file if it is not memory mapped). */
+	double HeaderTime;
+
+	/** Time spent opening or mapping the image file (in seconds). */
+	double OpenTime;
+
+	/** Default constructor. */
+	FExrMediaDecodeTimings()
+		: BytesRead(0)
+		, ConvertTime(0.0)
+		, DecompressTime(0.0)
+		, HeaderTime(0.0)
+		, OpenTime(0.0)
+	{ }
+
+	/** Get the total time spent decoding the frame (in seconds). */
+	double GetTotalTime() const
+	{
+		return OpenTime + HeaderTime + DecompressTime + ConvertTime;
+	}
+};
+
+
+/**
+ * Keeps a rolling window of the most recent samples of a time measurement.
+ *
+ * This class is not thread-safe; the owner is expected to synchronize access.
+ */
+class FExrMediaRollingTime
+{
+public:
+
+	/** Default constructor. */
+	FExrMediaRollingTime()
+		: NextSample(0)
+		, NumSamples(0)
+	{ }
+
+public:
+
+	/**
+	 * Add a sample, replacing the oldest one if the window is full.
+	 *
+	 * @param Seconds The time to add (in seconds).
+	 */
+	void Add(double Seconds);
+
+	/**
+	 * Get the average of the samples in the window.
+	 *
+	 * @return Average time (in seconds, 0.0 = no samples).
+	 */
+	double GetAverage() const;
+
+	/**
+	 * Get the smallest sample in the window.
+	 *
+	 * @return Minimum time (in seconds, 0.0 = no samples).
+	 */
+	double GetMin() const;
+
+	/**
+	 * Get the sample below which the specified fraction of samples in the window fall.
+	 *
+	 * @param Fraction The fraction of samples (i.e. 0.99 for the 99th percentile).
+	 * @return Percentile time (in seconds, 0.0 = no samples).
+	 */
+	double GetPercentile(float Fraction) const;
+
+	/**
+	 * Get a string with the minimum, average and 99th percentile of the window.
+	 *
+	 * @return The string (in milliseconds).
+	 */
+	FString ToString() const;
+
+private:
+
+	/** Number of samples in the window. */
+	static const int32 WindowSize = 128;
+
+	/** Index of the sample to replace next. */
+	int32 NextSample;
+
+	/** Number of valid samples. */
+	int32 NumSamples;
+
+	/** The sample ring buffer (in seconds). */
+	float Samples[WindowSize];
+};
+
+
+/**
+ * Collects playback statistics of an EXR media player.
+ *
+ * Decode timings are reported by decoder threads, the other statistics by
+ * the player. All methods are thread-safe.
+ */
+class FExrMediaPlaybackStats
+{
+public:
+
+	/** Default constructor. */
+	FExrMediaPlaybackStats();
+
+public:
+
+	/**
+	 * Add the timings of a decoded frame.
+	 *
+	 * @param Timings The frame's decode timings.
+	 */
+	void AddDecodedFrame(const FExrMediaDecodeTimings& Timings);
+
+	/**
+	 * Add the time it took to copy a frame into the video sink.
+	 *
+	 * @param Seconds The copy time (in seconds).
+	 */
+	void AddCopyTime(double Seconds);
+
+	/**
+	 * Add frames that were due but never displayed.
+	 *
+	 * @param NumFrames Number of dropped frames.
+	 */
+	void AddDroppedFrames(int32 NumFrames);
+
+	/** Add a frame interval during which the previous frame remained on display. */
+	void AddRepeatedFrame();
+
+	/**
+	 * Add the time from a seek until the first pixels of the target frame were displayed.
+	 *
+	 * @param Seconds The seek latency (in seconds).
+	 */
+	void AddSeekLatency(double Seconds);
+
+	/**
+	 * Publish the statistics to the ExrMedia stat group.
+	 *
+	 * @param NumCachedFrames Number of frames in the frame cache.
+	 * @param NumPrefetchedFrames Number of decoded frames in the prefetch window.
+	 */
+	void PublishStats(int32 NumCachedFrames, int32 NumPrefetchedFrames) const;
+
+	/** Reset all statistics. */
+	void Reset();
+
+	/**
+	 * Get a human readable string of the statistics.
+	 *
+	 * @return Statistics string.
+	 */
+	FString ToString() const;
+
+protected:
+
+	/**
+	 * Get the number of bytes of image data read per second.
+	 *
+	 * The caller must hold the critical section.
+	 *
+	 * @return Read rate (in bytes per second).
+	 */
+	double GetReadRate() const;
+
+private:
+
+	/** Critical section for synchronizing access to the statistics. */
+	mutable FCriticalSection CriticalSection;
+
+	/** Rolling time of converting decoded frames to the output format. */
+	FExrMediaRollingTime ConvertTime;
+
+	/** Rolling time of copying frames into the video sink. */
+	FExrMediaRollingTime CopyTime;
+
+	/** Rolling time of decompressing frames. */
+	FExrMediaRollingTime DecompressTime;
+
+	/** Rolling time of parsing image headers. */
+	FExrMediaRollingTime HeaderTime;
+
+	/** Number of frames decoded. */
+	uint64 NumDecodedFrames;
+
+	/** Number of frames that were due but never displayed. */
+	uint64 NumDroppedFrames;
+
+	/** Number of frame intervals during which the previous frame remained on display. */
+	uint64 NumRepeatedFrames;
+
+	/** Number of seeks that displayed their target frame. */
+	uint64 NumSeeks;
+
+	/** Rolling time of opening image files. */
+	FExrMediaRollingTime OpenTime;
+
+	/** Read rate over the previous measurement period (in bytes per second). */
+	double ReadRate;
+
+	/** Number of bytes read in the current measurement period. */
+	int64 ReadRateBytes;
+
+	/** Start of the current measurement period (in seconds). */
+	double ReadRateStartTime;
+
+	/** Rolling time from seeking to displaying the first pixels of the target frame. */
+	FExrMediaRollingTime SeekLatency;
+};
@@ -0,0 +1,209 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "ExrMediaTrace.h"
+#include "ExrMediaPrivate.h"
+
+#include "CoreGlobals.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTLS.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+
+/** Number of spans that the ring buffer holds. */
+static const int32 ExrMediaTraceCapacity = 65536;
+
+/** Number of seconds that ExrMedia.DumpTrace writes by default. */
+static const double ExrMediaTraceDefaultSeconds = 10.0;
+
+
+static TAutoConsoleVariable<int32> CVarExrMediaTrace(
+	TEXT("ExrMedia.Trace"),
+	0,
+	TEXT("Whether to record trace spans of EXR media playback for ExrMedia.DumpTrace.\n")
+	TEXT("0: off (default)\n")
+	TEXT("1: on"));
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/**
+ * A single recorded span.
+ */
+struct FExrMediaTraceSpan
+{
+	/** Time at which the span ended (in seconds). */
+	double EndTime;
+
+	/** Index of the frame that the span worked on, or INDEX_NONE. */
+	int32 FrameIndex;
+
+	/** The span's name. */
+	const TCHAR* Name;
+
+	/** Time at which the span started (in seconds). */
+	double StartTime;
+
+	/** Identifier of the thread that recorded the span. */
+	uint32 ThreadId;
+};
+
+
+/**
+ * The ring buffer of recorded spans.
+ */
+struct FExrMediaTraceBuffer
+{
+	/** Critical section for synchronizing access to the buffer. */
+	FCriticalSection CriticalSection;
+
+	/** Index of the span to replace next. */
+	int32 NextSpan;
+
+	/** Number of valid spans. */
+	int32 NumSpans;
+
+	/** The spans (allocated on first use). */
+	TArray<FExrMediaTraceSpan> Spans;
+
+	/** Default constructor. */
+	FExrMediaTraceBuffer()
+		: NextSpan(0)
+		, NumSpans(0)
+	{ }
+};
+
+
+/** Get the ring buffer of recorded spans. */
+static FExrMediaTraceBuffer& ExrMediaGetTraceBuffer()
+{
+	static FExrMediaTraceBuffer Buffer;
+	return Buffer;
+}
+
+
+/** Handle the ExrMedia.DumpTrace console command. */
+static void ExrMediaDumpTrace(const TArray<FString>& Args)
+{
+	const double Seconds = (Args.Num() > 0) ? FCString::Atod(*Args[0]) : ExrMediaTraceDefaultSeconds;
+	const FString FilePath = FPaths::Combine(*FPaths::ProfilingDir(), TEXT("ExrMedia"), *FString::Printf(TEXT("ExrMediaTrace-%s.json"), *FDateTime::Now().ToString()));
+
+	if (!FExrMediaTrace::IsEnabled())
+	{
+		UE_LOG(LogExrMedia, Warning, TEXT("Trace recording is off; set ExrMedia.Trace to 1 before playback"));
+	}
+
+	if (FExrMediaTrace::SaveToFile(FilePath, (Seconds > 0.0) ? Seconds : ExrMediaTraceDefaultSeconds))
+	{
+		UE_LOG(LogExrMedia, Display, TEXT("Wrote EXR media trace to %s"), *FPaths::ConvertRelativePathToFull(FilePath));
+	}
+	else
+	{
+		UE_LOG(LogExrMedia, Warning, TEXT("Failed to write EXR media trace to %s"), *FilePath);
+	}
+}
+
+
+static FAutoConsoleCommand ExrMediaDumpTraceCommand(
+	TEXT("ExrMedia.DumpTrace"),
+	TEXT("Write the EXR media trace spans of the last N seconds (default 10) to a Chrome trace JSON file in the profiling directory.\n")
+	TEXT("Usage: ExrMedia.DumpTrace [Seconds]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&ExrMediaDumpTrace));
+
+
+/* FExrMediaTrace interface
+ *****************************************************************************/
+
+void FExrMediaTrace::AddSpan(const TCHAR* Name, double StartTime, double EndTime, int32 FrameIndex)
+{
+	const uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
+	FExrMediaTraceBuffer& Buffer = ExrMediaGetTraceBuffer();
+
+	FScopeLock Lock(&Buffer.CriticalSection);
+
+	if (Buffer.Spans.Num() == 0)
+	{
+		Buffer.Spans.AddUninitialized(ExrMediaTraceCapacity);
+	}
+
+	FExrMediaTraceSpan& Span = Buffer.Spans[Buffer.NextSpan];
+	{
+		Span.EndTime = EndTime;
+		Span.FrameIndex = FrameIndex;
+		Span.Name = Name;
+		Span.StartTime = StartTime;
+		Span.ThreadId = ThreadId;
+	}
+
+	Buffer.NextSpan = (Buffer.NextSpan + 1) % ExrMediaTraceCapacity;
+	Buffer.NumSpans = FMath::Min(Buffer.NumSpans + 1, ExrMediaTraceCapacity);
+}
+
+
+bool FExrMediaTrace::IsEnabled()
+{
+	return (CVarExrMediaTrace.GetValueOnAnyThread() != 0);
+}
+
+
+bool FExrMediaTrace::SaveToFile(const FString& FilePath, double Seconds)
+{
+	const double MinEndTime = FPlatformTime::Seconds() - Seconds;
+	TArray<FExrMediaTraceSpan> Spans;
+
+	// copy the spans, so that recording is not blocked while formatting
+	{
+		FExrMediaTraceBuffer& Buffer = ExrMediaGetTraceBuffer();
+		FScopeLock Lock(&Buffer.CriticalSection);
+
+		const int32 FirstSpan = (Buffer.NextSpan - Buffer.NumSpans + ExrMediaTraceCapacity) % ExrMediaTraceCapacity;
+
+		for (int32 SpanIndex = 0; SpanIndex < Buffer.NumSpans; ++SpanIndex)
+		{
+			const FExrMediaTraceSpan& Span = Buffer.Spans[(FirstSpan + SpanIndex) % ExrMediaTraceCapacity];
+
+			if (Span.EndTime >= MinEndTime)
+			{
+				Spans.Add(Span);
+			}
+		}
+	}
+
+	if (Spans.Num() == 0)
+	{
+		return false;
+	}
+
+	// nested spans end before their parents, so spans are sorted by start time
+	Spans.Sort([](const FExrMediaTraceSpan& A, const FExrMediaTraceSpan& B) {
+		return A.StartTime < B.StartTime;
+	});
+
+	const double BaseTime = Spans[0].StartTime;
+	FString Json;
+
+	Json.Reserve(Spans.Num() * 128);
+	Json += TEXT("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	Json += FString::Printf(TEXT("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"GameThread\"}}"), GGameThreadId);
+
+	for (const FExrMediaTraceSpan& Span : Spans)
+	{
+		// timestamps and durations are in microseconds
+		Json += FString::Printf(TEXT(",\n{\"name\":\"%s\",\"cat\":\"ExrMedia\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f"),
+			Span.Name, Span.ThreadId, (Span.StartTime - BaseTime) * 1000000.0, (Span.EndTime - Span.StartTime) * 1000000.0);
+
+		if (Span.FrameIndex != INDEX_NONE)
+		{
+			Json += FString::Printf(TEXT(",\"args\":{\"frame\":%i}"), Span.FrameIndex);
+		}
+
+		Json += TEXT("}");
+	}
+
+	Json += TEXT("\n]}\n");
+
+	return FFileHelper::SaveStringToFile(Json, *FilePath);
+}
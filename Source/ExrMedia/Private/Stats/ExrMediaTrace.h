@@ -0,0 +1,98 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/UnrealString.h"
+#include "HAL/PlatformTime.h"
+
+
+/**
+ * Records timed spans of playback work for export as a Chrome trace.
+ *
+ * Spans of all players and threads go into a shared ring buffer, so that
+ * the most recent spans can be dumped at any time. Recording is off unless
+ * the ExrMedia.Trace console variable is set; the ExrMedia.DumpTrace console
+ * command writes the spans of the last few seconds to a JSON file that can be
+ * loaded into chrome://tracing.
+ *
+ * All methods are thread-safe.
+ */
+class FExrMediaTrace
+{
+public:
+
+	/**
+	 * Add a span to the ring buffer, replacing the oldest one if the buffer is full.
+	 *
+	 * @param Name The span's name (must be a string literal).
+	 * @param StartTime Time at which the span started (in seconds).
+	 * @param EndTime Time at which the span ended (in seconds).
+	 * @param FrameIndex Index of the frame that the span worked on, or INDEX_NONE.
+	 */
+	static void AddSpan(const TCHAR* Name, double StartTime, double EndTime, int32 FrameIndex);
+
+	/**
+	 * Check whether spans are being recorded.
+	 *
+	 * @return true if recording is enabled, false otherwise.
+	 */
+	static bool IsEnabled();
+
+	/**
+	 * Write the recorded spans of the last few seconds to a Chrome trace JSON file.
+	 *
+	 * @param FilePath Path to the file to write.
+	 * @param Seconds Number of seconds to write, counting back from now.
+	 * @return true on success, false if there are no spans or the file could not be written.
+	 */
+	static bool SaveToFile(const FString& FilePath, double Seconds);
+};
+
+
+/**
+ * Records a span from construction to destruction of this object.
+ *
+ * @see EXRMEDIA_TRACE_SCOPE
+ */
+class FExrMediaTraceScope
+{
+public:
+
+	/**
+	 * Create and initialize a new instance.
+	 *
+	 * @param InName The span's name (must be a string literal).
+	 * @param InFrameIndex Index of the frame that the span works on, or INDEX_NONE.
+	 */
+	FExrMediaTraceScope(const TCHAR* InName, int32 InFrameIndex)
+		: FrameIndex(InFrameIndex)
+		, Name(InName)
+		, StartTime(FExrMediaTrace::IsEnabled() ? FPlatformTime::Seconds() : 0.0)
+	{ }
+
+	/** Destructor. */
+	~FExrMediaTraceScope()
+	{
+		if (StartTime > 0.0)
+		{
+			FExrMediaTrace::AddSpan(Name, StartTime, FPlatformTime::Seconds(), FrameIndex);
+		}
+	}
+
+private:
+
+	/** Index of the frame that the span works on. */
+	int32 FrameIndex;
+
+	/** The span's name. */
+	const TCHAR* Name;
+
+	/** Time at which the span started (0.0 = not recording). */
+	double StartTime;
+};
+
+
+/** Record a trace span with the given name literal for the rest of the enclosing scope. */
+#define EXRMEDIA_TRACE_SCOPE(Name, FrameIndex) \
+	FExrMediaTraceScope ANONYMOUS_VARIABLE(ExrMediaTraceScope)(TEXT(Name), FrameIndex)
@@ -11,6 +11,40 @@
 #include "ExrMediaSource.generated.h"
 
 
+/**
+ * Available pixel formats for EXR image sequence output.
+ */
+UENUM(BlueprintType)
+enum class EExrMediaOutputFormat : uint8
+{
+	/** Output 16-bit floating point RGBA pixels with the full dynamic range of the images. */
+	Hdr UMETA(DisplayName="HDR (16-bit float RGBA)"),
+
+	/** Output 8-bit sRGB BGRA pixels, which halves memory usage and upload bandwidth. */
+	Ldr UMETA(DisplayName="LDR (8-bit sRGB BGRA)")
+};
+
+
+/**
+ * Available resolutions for proxy playback of EXR image sequences.
+ */
+UENUM(BlueprintType)
+enum class EExrMediaProxyResolution : uint8
+{
+	/** Play the image sequence at its full resolution. */
+	Full,
+
+	/** Play the image sequence at half its width and height. */
+	Half,
+
+	/** Play the image sequence at a quarter of its width and height. */
+	Quarter,
+
+	/** Play the image sequence at an eighth of its width and height. */
+	Eighth
+};
+
+
 /**
  * Media source for EXR image sequences.
  */
@@ -27,10 +61,56 @@ public:
 
 public:
 
+	/** Maximum number of frames to decode in parallel (0 = up to the project's shared decoder threads). */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=EXR, AdvancedDisplay, meta=(ClampMin="0"))
+	int32 DecoderThreads;
+
+	/**
+	 * Exposure adjustment applied when converting to LDR output (in stops).
+	 *
+	 * The color channels are multiplied by 2^Exposure before they are clamped
+	 * and encoded with the sRGB transfer function.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=EXR)
+	float Exposure;
+
 	/** Overrides the default frame rate stored in the EXR image files (0.0 = do not override). */
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=EXR, AdvancedDisplay)
 	float FramesPerSecondOverride;
 
+	/**
+	 * Number of decoded frames that are held for display ahead of their presentation time (0 = unbuffered output).
+	 *
+	 * When enabled, frames are uploaded through a buffered texture sink, which decouples decoding from rendering.
+	 * If decoding briefly falls behind, the newest buffered frame whose time has passed is displayed until the
+	 * due frame is ready, instead of holding the previously displayed frame.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=EXR, AdvancedDisplay, meta=(ClampMin="0"))
+	int32 OutputBuffers;
+
+	/**
+	 * The pixel format of the output frames.
+	 *
+	 * LDR frames are converted from half-float to 8-bit while decoding, which
+	 * suits playback on LDR displays at half the memory and upload bandwidth.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=EXR)
+	EExrMediaOutputFormat OutputFormat;
+
+	/** Number of frames to decode ahead of the current play position on a background thread. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=EXR, AdvancedDisplay, meta=(ClampMin="1"))
+	int32 PrefetchDepth;
+
+	/**
+	 * The resolution at which the image sequence is played.
+	 *
+	 * Reduced resolutions are read from the mip levels of tiled images, which
+	 * reads and decodes only a fraction of the data of each frame. Images without
+	 * mip levels are box filtered down to the reduced resolution while decoding.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=EXR)
+	EExrMediaProxyResolution ProxyResolution;
+
 public:
 
 	/**
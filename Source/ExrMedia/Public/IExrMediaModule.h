@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "Containers/UnrealString.h"
 #include "Templates/SharedPointer.h"
 #include "Modules/ModuleInterface.h"
 
@@ -23,6 +24,17 @@ public:
 	 */
 	virtual TSharedPtr<IMediaPlayer> CreatePlayer() = 0;
 
+	/**
+	 * Packs an EXR image sequence into a single sequence container file.
+	 *
+	 * Sequence containers can be played with exrpak:// URLs.
+	 *
+	 * @param SequencePath Path to the image sequence directory.
+	 * @param ContainerPath Path to the container file to create.
+	 * @return true on success, false otherwise.
+	 */
+	virtual bool PackSequence(const FString& SequencePath, const FString& ContainerPath) = 0;
+
 public:
 
 	/** Virtual destructor. */
@@ -14,8 +14,10 @@ namespace UnrealBuildTool.Rules
 					"CoreUObject",
                     "DesktopWidgets",
                     "EditorStyle",
+                    "Engine",
                     "ExrMedia",
 					"MediaAssets",
+                    "OpenExrWrapper",
                     "Slate",
                     "SlateCore",
                     "UnrealEd",
@@ -24,6 +26,7 @@ namespace UnrealBuildTool.Rules
 
             PrivateIncludePathModuleNames.AddRange(
                 new string[] {
+                    "AssetRegistry",
                     "AssetTools",
                 }
             );
@@ -31,6 +34,7 @@ namespace UnrealBuildTool.Rules
             PrivateIncludePaths.AddRange(
 				new string[] {
 					"ExrMediaEditor/Private",
+                    "ExrMediaEditor/Private/Commandlets",
                     "ExrMediaEditor/Private/Customizations",
                     "ExrMediaEditor/Private/Factories",
                 }
@@ -0,0 +1,456 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "ExrMediaBenchmarkCommandlet.h"
+
+#include "Async/ParallelFor.h"
+#include "ExrMediaCompressions.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformProperties.h"
+#include "HAL/PlatformTime.h"
+#include "Math/Float16.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+
+DEFINE_LOG_CATEGORY_STATIC(LogExrMediaBenchmarkCommandlet, Log, All);
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/** Channel sets that synthetic sequences can be generated with. */
+static const struct
+{
+	const TCHAR* Name;
+	EExrRgbaChannels Channels;
+}
+ExrMediaChannelSets[] =
+{
+	{ TEXT("Rgba"), EExrRgbaChannels::Rgba },
+	{ TEXT("Rgb"), EExrRgbaChannels::Rgb },
+	{ TEXT("Ya"), EExrRgbaChannels::Ya },
+	{ TEXT("Y"), EExrRgbaChannels::Y },
+};
+
+
+/** Get the name of the specified channel set. */
+static const TCHAR* ExrMediaChannelSetName(EExrRgbaChannels Channels)
+{
+	for (const auto& Entry : ExrMediaChannelSets)
+	{
+		if (Entry.Channels == Channels)
+		{
+			return Entry.Name;
+		}
+	}
+
+	return TEXT("Unknown");
+}
+
+
+/** Parse a comma separated list parameter, or use the given default list if the parameter is not specified. */
+static TArray<FString> ExrMediaParseList(const FString& Params, const TCHAR* Match, const TCHAR* DefaultValue)
+{
+	FString Value = DefaultValue;
+	FParse::Value(*Params, Match, Value, false);
+
+	TArray<FString> Items;
+	Value.ParseIntoArray(Items, TEXT(","), true);
+
+	return Items;
+}
+
+
+/**
+ * Generate the pixels of a synthetic frame.
+ *
+ * The frames show smooth gradients with film grain, which is what compressors
+ * struggle with in rendered footage, and a bright highlight that moves across
+ * the sequence. The grain is hashed from the pixel position and frame index,
+ * so that the same frames are generated on every run.
+ */
+static void ExrMediaGeneratePixels(const FIntPoint& Dim, int32 FrameIndex, int32 NumFrames, TArray<FFloat16>& OutPixels)
+{
+	OutPixels.SetNumUninitialized(Dim.X * Dim.Y * 4);
+
+	const float Phase = (FrameIndex + 0.5f) / NumFrames;
+
+	ParallelFor(Dim.Y, [&](int32 Y)
+	{
+		FFloat16* Pixel = OutPixels.GetData() + Y * Dim.X * 4;
+		const float V = (float)Y / Dim.Y;
+
+		for (int32 X = 0; X < Dim.X; ++X, Pixel += 4)
+		{
+			const float U = (float)X / Dim.X;
+
+			uint32 Hash = ((uint32)X * 73856093u) ^ ((uint32)Y * 19349663u) ^ ((uint32)FrameIndex * 83492791u);
+			Hash = (Hash ^ (Hash >> 13)) * 0x5bd1e995u;
+			Hash ^= Hash >> 15;
+
+			const float Grain = ((Hash & 0xffff) / 65535.0f - 0.5f) * 0.02f;
+			const float Dx = U - Phase;
+			const float Dy = V - 0.5f;
+			const float Highlight = 4.0f * FMath::Exp(-(Dx * Dx + Dy * Dy) * 50.0f);
+
+			Pixel[0] = U + Highlight + Grain;
+			Pixel[1] = V + Highlight + Grain;
+			Pixel[2] = 0.5f * (1.0f - U) + Highlight + Grain;
+			Pixel[3] = 1.0f;
+		}
+	});
+}
+
+
+/* FExrMediaBenchmarkResult interface
+ *****************************************************************************/
+
+double FExrMediaBenchmarkResult::GetLatency(float Fraction) const
+{
+	if (Latencies.Num() == 0)
+	{
+		return 0.0;
+	}
+
+	TArray<double> SortedLatencies = Latencies;
+	SortedLatencies.Sort();
+
+	return SortedLatencies[FMath::Clamp(FMath::CeilToInt(Fraction * SortedLatencies.Num()) - 1, 0, SortedLatencies.Num() - 1)];
+}
+
+
+/* UExrMediaBenchmarkCommandlet structors
+ *****************************************************************************/
+
+UExrMediaBenchmarkCommandlet::UExrMediaBenchmarkCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+	, NumFrames(8)
+	, NumPasses(3)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+
+/* UCommandlet interface
+ *****************************************************************************/
+
+int32 UExrMediaBenchmarkCommandlet::Main(const FString& Params)
+{
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("Passes="), NumPasses);
+
+	NumFrames = FMath::Max(1, NumFrames);
+	NumPasses = FMath::Max(1, NumPasses);
+
+	// parse the benchmark matrix
+	TArray<FIntPoint> Resolutions;
+
+	for (const FString& Item : ExrMediaParseList(Params, TEXT("Resolutions="), TEXT("1920x1080,3840x2160")))
+	{
+		FString Width, Height;
+
+		if (!Item.Split(TEXT("x"), &Width, &Height) || (FCString::Atoi(*Width) <= 0) || (FCString::Atoi(*Height) <= 0))
+		{
+			UE_LOG(LogExrMediaBenchmarkCommandlet, Error, TEXT("Invalid resolution %s"), *Item);
+			return 1;
+		}
+
+		Resolutions.Add(FIntPoint(FCString::Atoi(*Width), FCString::Atoi(*Height)));
+	}
+
+	TArray<EExrRgbaChannels> ChannelSets;
+
+	for (const FString& Item : ExrMediaParseList(Params, TEXT("Channels="), TEXT("Rgba,Rgb,Y")))
+	{
+		const int32 NumChannelSets = ChannelSets.Num();
+
+		for (const auto& Entry : ExrMediaChannelSets)
+		{
+			if (Item == Entry.Name)
+			{
+				ChannelSets.Add(Entry.Channels);
+			}
+		}
+
+		if (ChannelSets.Num() == NumChannelSets)
+		{
+			UE_LOG(LogExrMediaBenchmarkCommandlet, Error, TEXT("Unknown channel set %s"), *Item);
+			return 1;
+		}
+	}
+
+	TArray<EExrCompression> Compressions;
+
+	for (const FString& Item : ExrMediaParseList(Params, TEXT("Compressions="), TEXT("None,Rle,Zip,Zips,Piz,B44,Dwaa")))
+	{
+		const EExrCompression Compression = ExrMediaParseCompression(Item);
+
+		if (Compression == EExrCompression::Unknown)
+		{
+			UE_LOG(LogExrMediaBenchmarkCommandlet, Error, TEXT("Unknown compression %s"), *Item);
+			return 1;
+		}
+
+		Compressions.Add(Compression);
+	}
+
+	TArray<int32> ThreadCounts;
+
+	for (const FString& Item : ExrMediaParseList(Params, TEXT("Threads="), TEXT("0,2,4,8")))
+	{
+		ThreadCounts.Add(FMath::Max(0, FCString::Atoi(*Item)));
+	}
+
+	FString OutputPath = FPaths::GameSavedDir() / TEXT("ExrMediaBenchmark");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	FPaths::NormalizeDirectoryName(OutputPath);
+
+	FString ReportPath = OutputPath / FString::Printf(TEXT("ExrMediaBenchmark-%s.json"), *FDateTime::Now().ToString());
+	FParse::Value(*Params, TEXT("Report="), ReportPath);
+
+	const bool KeepSequences = FParse::Param(*Params, TEXT("KeepSequences"));
+
+	// run the benchmark matrix
+	const int32 GlobalThreadCount = FRgbaInputFile::GetGlobalThreadCount();
+	TArray<FExrMediaBenchmarkResult> Results;
+	int32 NumFailed = 0;
+
+	for (const FIntPoint& Dim : Resolutions)
+	{
+		for (EExrRgbaChannels Channels : ChannelSets)
+		{
+			for (EExrCompression Compression : Compressions)
+			{
+				const FString SequencePath = OutputPath / FString::Printf(TEXT("%ix%i_%s_%s"), Dim.X, Dim.Y, ExrMediaChannelSetName(Channels), ExrMediaCompressionName(Compression));
+
+				UE_LOG(LogExrMediaBenchmarkCommandlet, Display, TEXT("Generating %i frames of %ix%i %s %s in %s"), NumFrames, Dim.X, Dim.Y, ExrMediaChannelSetName(Channels), ExrMediaCompressionName(Compression), *SequencePath);
+
+				if (!GenerateSequence(SequencePath, Dim, Channels, Compression))
+				{
+					if (!KeepSequences)
+					{
+						IFileManager::Get().DeleteDirectory(*SequencePath, false, true);
+					}
+
+					++NumFailed;
+					continue;
+				}
+
+				for (int32 NumThreads : ThreadCounts)
+				{
+					FExrMediaBenchmarkResult Result;
+					{
+						Result.Channels = Channels;
+						Result.Compression = Compression;
+					}
+
+					if (!MeasureSequence(SequencePath, NumThreads, Result))
+					{
+						++NumFailed;
+						continue;
+					}
+
+					UE_LOG(LogExrMediaBenchmarkCommandlet, Display, TEXT("    %2i threads: %7.2f fps, %8.2f MP/s, %8.2f MB/s, latency min %.2f / p50 %.2f / p95 %.2f / max %.2f ms"),
+						NumThreads,
+						Result.GetFramesPerSecond(),
+						Result.GetMegapixelsPerSecond(),
+						Result.GetMegabytesPerSecond(),
+						Result.GetLatency(0.0f) * 1000.0,
+						Result.GetLatency(0.5f) * 1000.0,
+						Result.GetLatency(0.95f) * 1000.0,
+						Result.GetLatency(1.0f) * 1000.0);
+
+					Results.Add(MoveTemp(Result));
+				}
+
+				if (!KeepSequences)
+				{
+					IFileManager::Get().DeleteDirectory(*SequencePath, false, true);
+				}
+			}
+		}
+	}
+
+	FRgbaInputFile::SetGlobalThreadCount(GlobalThreadCount);
+
+	if (!SaveReport(ReportPath, Results))
+	{
+		UE_LOG(LogExrMediaBenchmarkCommandlet, Error, TEXT("Failed to write benchmark report %s"), *ReportPath);
+		return 1;
+	}
+
+	UE_LOG(LogExrMediaBenchmarkCommandlet, Display, TEXT("Wrote %i benchmark results to %s"), Results.Num(), *FPaths::ConvertRelativePathToFull(ReportPath));
+
+	return (NumFailed == 0) ? 0 : 1;
+}
+
+
+/* UExrMediaBenchmarkCommandlet implementation
+ *****************************************************************************/
+
+bool UExrMediaBenchmarkCommandlet::GenerateSequence(const FString& SequencePath, const FIntPoint& Dim, EExrRgbaChannels Channels, EExrCompression Compression) const
+{
+	if (!IFileManager::Get().MakeDirectory(*SequencePath, true))
+	{
+		UE_LOG(LogExrMediaBenchmarkCommandlet, Error, TEXT("Failed to create directory %s"), *SequencePath);
+		return false;
+	}
+
+	// frames are encoded one at a time, with all cores compressing line blocks
+	const int32 NumThreads = FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+	FRgbaInputFile::SetGlobalThreadCount(NumThreads);
+
+	TArray<FFloat16> Pixels;
+
+	for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+	{
+		ExrMediaGeneratePixels(Dim, FrameIndex, NumFrames, Pixels);
+
+		const FString ImagePath = SequencePath / FString::Printf(TEXT("Frame_%04i.exr"), FrameIndex);
+		FRgbaOutputFile OutputFile(ImagePath, Dim, Compression, Channels, 24.0, NumThreads);
+
+		// i.e. the linked OpenEXR does not support the compression, or the disk is full
+		if (!OutputFile.IsValid())
+		{
+			UE_LOG(LogExrMediaBenchmarkCommandlet, Error, TEXT("Failed to create image file %s"), *ImagePath);
+			return false;
+		}
+
+		OutputFile.SetFrameBuffer(Pixels.GetData(), Dim);
+
+		if (!OutputFile.WritePixels(Dim.Y))
+		{
+			UE_LOG(LogExrMediaBenchmarkCommandlet, Error, TEXT("Failed to write image file %s"), *ImagePath);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+bool UExrMediaBenchmarkCommandlet::MeasureSequence(const FString& SequencePath, int32 NumThreads, FExrMediaBenchmarkResult& OutResult) const
+{
+	TArray<FString> FileNames;
+	IFileManager::Get().FindFiles(FileNames, *(SequencePath / TEXT("*.exr")), true, false);
+
+	if (FileNames.Num() == 0)
+	{
+		UE_LOG(LogExrMediaBenchmarkCommandlet, Error, TEXT("The directory %s does not contain any .exr image files"), *SequencePath);
+		return false;
+	}
+
+	FileNames.Sort();
+
+	int64 TotalFileSize = 0;
+
+	for (const FString& FileName : FileNames)
+	{
+		TotalFileSize += IFileManager::Get().FileSize(*(SequencePath / FileName));
+	}
+
+	FRgbaInputFile::SetGlobalThreadCount(NumThreads);
+
+	{
+		FRgbaInputFile FirstFile(SequencePath / FileNames[0], 0);
+
+		if (!FirstFile.IsValid())
+		{
+			UE_LOG(LogExrMediaBenchmarkCommandlet, Error, TEXT("Failed to open image file %s"), *FileNames[0]);
+			return false;
+		}
+
+		OutResult.Dim = FirstFile.GetDataWindow();
+	}
+
+	OutResult.AverageFileSize = TotalFileSize / FileNames.Num();
+	OutResult.Latencies.Empty(FileNames.Num() * NumPasses);
+	OutResult.NumThreads = NumThreads;
+	OutResult.TotalTime = 0.0;
+
+	TArray<uint16> Pixels;
+	Pixels.SetNumUninitialized(OutResult.Dim.X * OutResult.Dim.Y * 4);
+
+	// the first pass only warms up the file cache and OpenEXR's thread pool
+	for (int32 Pass = 0; Pass <= NumPasses; ++Pass)
+	{
+		for (const FString& FileName : FileNames)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+
+			FRgbaInputFile InputFile(SequencePath / FileName, NumThreads);
+
+			if (!InputFile.IsValid())
+			{
+				UE_LOG(LogExrMediaBenchmarkCommandlet, Error, TEXT("Failed to open image file %s"), *FileName);
+				return false;
+			}
+
+			if (InputFile.GetDataWindow() != OutResult.Dim)
+			{
+				UE_LOG(LogExrMediaBenchmarkCommandlet, Error, TEXT("Image file %s is not %s"), *FileName, *OutResult.Dim.ToString());
+				return false;
+			}
+
+			// failed decodes must not be reported as throughput
+			if (!InputFile.SetFrameBuffer(Pixels.GetData(), OutResult.Dim) || !InputFile.ReadPixels(0, OutResult.Dim.Y - 1))
+			{
+				UE_LOG(LogExrMediaBenchmarkCommandlet, Error, TEXT("Failed to decode image file %s"), *FileName);
+				return false;
+			}
+
+			const double Latency = FPlatformTime::Seconds() - StartTime;
+
+			if (Pass > 0)
+			{
+				OutResult.Latencies.Add(Latency);
+				OutResult.TotalTime += Latency;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+bool UExrMediaBenchmarkCommandlet::SaveReport(const FString& ReportPath, const TArray<FExrMediaBenchmarkResult>& Results) const
+{
+	FString CpuBrand = FPlatformMisc::GetCPUBrand().Trim().TrimTrailing();
+	CpuBrand.ReplaceInline(TEXT("\""), TEXT("'"));
+
+	FString Json;
+
+	Json += TEXT("{\n");
+	Json += FString::Printf(TEXT("\t\"date\": \"%s\",\n"), *FDateTime::UtcNow().ToIso8601());
+	Json += FString::Printf(TEXT("\t\"platform\": \"%s\",\n"), ANSI_TO_TCHAR(FPlatformProperties::PlatformName()));
+	Json += FString::Printf(TEXT("\t\"cpu\": \"%s\",\n"), *CpuBrand);
+	Json += FString::Printf(TEXT("\t\"cores\": %i,\n"), FPlatformMisc::NumberOfCores());
+	Json += FString::Printf(TEXT("\t\"logicalCores\": %i,\n"), FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+	Json += FString::Printf(TEXT("\t\"frames\": %i,\n"), NumFrames);
+	Json += FString::Printf(TEXT("\t\"passes\": %i,\n"), NumPasses);
+	Json += TEXT("\t\"results\": [");
+
+	for (int32 ResultIndex = 0; ResultIndex < Results.Num(); ++ResultIndex)
+	{
+		const FExrMediaBenchmarkResult& Result = Results[ResultIndex];
+
+		Json += (ResultIndex > 0) ? TEXT(",\n") : TEXT("\n");
+		Json += TEXT("\t\t{ ");
+		Json += FString::Printf(TEXT("\"width\": %i, \"height\": %i, \"channels\": \"%s\", \"compression\": \"%s\", \"threads\": %i, "),
+			Result.Dim.X, Result.Dim.Y, ExrMediaChannelSetName(Result.Channels), ExrMediaCompressionName(Result.Compression), Result.NumThreads);
+		Json += FString::Printf(TEXT("\"fileSize\": %lld, \"decodes\": %i, \"framesPerSecond\": %.3f, \"megapixelsPerSecond\": %.3f, \"megabytesPerSecond\": %.3f, "),
+			Result.AverageFileSize, Result.Latencies.Num(), Result.GetFramesPerSecond(), Result.GetMegapixelsPerSecond(), Result.GetMegabytesPerSecond());
+		Json += FString::Printf(TEXT("\"latencyMinMs\": %.3f, \"latencyMedianMs\": %.3f, \"latencyP95Ms\": %.3f, \"latencyMaxMs\": %.3f }"),
+			Result.GetLatency(0.0f) * 1000.0, Result.GetLatency(0.5f) * 1000.0, Result.GetLatency(0.95f) * 1000.0, Result.GetLatency(1.0f) * 1000.0);
+	}
+
+	Json += TEXT("\n\t]\n}\n");
+
+	return FFileHelper::SaveStringToFile(Json, *ReportPath);
+}
@@ -0,0 +1,147 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "Containers/Array.h"
+#include "Math/IntPoint.h"
+#include "Math/UnrealMathUtility.h"
+#include "OpenExrWrapper.h"
+#include "UObject/ObjectMacros.h"
+
+#include "ExrMediaBenchmarkCommandlet.generated.h"
+
+
+/**
+ * Decode measurements of a synthetic sequence at one thread count.
+ */
+struct FExrMediaBenchmarkResult
+{
+	/** Average size of the sequence's image files (in bytes). */
+	int64 AverageFileSize;
+
+	/** Channels stored in the image files. */
+	EExrRgbaChannels Channels;
+
+	/** Compression of the image files. */
+	EExrCompression Compression;
+
+	/** Width and height of the frames (in pixels). */
+	FIntPoint Dim;
+
+	/** Decode latency of each decoded frame (in seconds). */
+	TArray<double> Latencies;
+
+	/** Number of OpenEXR threads that the frames were decoded with. */
+	int32 NumThreads;
+
+	/** Total time spent decoding all frames (in seconds). */
+	double TotalTime;
+
+	/** Default constructor. */
+	FExrMediaBenchmarkResult()
+		: AverageFileSize(0)
+		, Channels(EExrRgbaChannels::Rgba)
+		, Compression(EExrCompression::None)
+		, Dim(FIntPoint::ZeroValue)
+		, NumThreads(0)
+		, TotalTime(0.0)
+	{ }
+
+	/** Get the number of frames decoded per second. */
+	double GetFramesPerSecond() const
+	{
+		return Latencies.Num() / FMath::Max(TotalTime, (double)SMALL_NUMBER);
+	}
+
+	/** Get the number of megabytes of image data decoded per second. */
+	double GetMegabytesPerSecond() const
+	{
+		return GetFramesPerSecond() * AverageFileSize / (1024.0 * 1024.0);
+	}
+
+	/** Get the number of megapixels decoded per second. */
+	double GetMegapixelsPerSecond() const
+	{
+		return GetFramesPerSecond() * Dim.X * Dim.Y / 1000000.0;
+	}
+
+	/**
+	 * Get the latency below which the specified fraction of decodes fall.
+	 *
+	 * @param Fraction The fraction of decodes (0.0 = minimum, 0.5 = median, 1.0 = maximum).
+	 * @return Latency (in seconds, 0.0 = no decodes).
+	 */
+	double GetLatency(float Fraction) const;
+};
+
+
+/**
+ * Measures how fast EXR image sequences decode.
+ *
+ * Usage: -run=ExrMediaBenchmark [-Resolutions=<WxH,...>] [-Channels=<Rgba,Rgb,Ya,Y,...>]
+ *        [-Compressions=<Name,...>] [-Threads=<N,...>] [-Frames=<N>] [-Passes=<N>]
+ *        [-Output=<Directory>] [-Report=<File>] [-KeepSequences]
+ *
+ * For every combination of resolution, channel set and compression, a synthetic
+ * sequence of gradients with film grain and highlights is generated in the output
+ * directory (Saved/ExrMediaBenchmark by default). Each sequence is then decoded
+ * through FRgbaInputFile with each of the given OpenEXR thread counts, one frame at
+ * a time, for the given number of passes after one warm-up pass.
+ *
+ * The results are logged and written as JSON to the report file (a timestamped file
+ * in the output directory by default), with decode throughput and latency percentiles
+ * per run, so that they can be compared across builds and machines.
+ */
+UCLASS()
+class UExrMediaBenchmarkCommandlet
+	: public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	//~ UCommandlet interface
+
+	virtual int32 Main(const FString& Params) override;
+
+protected:
+
+	/**
+	 * Write a synthetic image sequence.
+	 *
+	 * @param SequencePath Path to the directory to write the sequence to.
+	 * @param Dim Width and height of the frames (in pixels).
+	 * @param Channels The channels to store.
+	 * @param Compression The compression to use.
+	 * @return true on success, false otherwise.
+	 */
+	bool GenerateSequence(const FString& SequencePath, const FIntPoint& Dim, EExrRgbaChannels Channels, EExrCompression Compression) const;
+
+	/**
+	 * Decode a synthetic image sequence and measure the decode times.
+	 *
+	 * @param SequencePath Path to the image sequence directory.
+	 * @param NumThreads Number of OpenEXR threads to decode with (0 = decode on the calling thread).
+	 * @param OutResult Will contain the measurements.
+	 * @return true on success, false if a frame failed to decode.
+	 */
+	bool MeasureSequence(const FString& SequencePath, int32 NumThreads, FExrMediaBenchmarkResult& OutResult) const;
+
+	/**
+	 * Write the results of all runs to a JSON report file.
+	 *
+	 * @param ReportPath Path to the report file.
+	 * @param Results The results to write.
+	 * @return true on success, false otherwise.
+	 */
+	bool SaveReport(const FString& ReportPath, const TArray<FExrMediaBenchmarkResult>& Results) const;
+
+private:
+
+	/** Number of frames per synthetic sequence. */
+	int32 NumFrames;
+
+	/** Number of measured decode passes over each sequence. */
+	int32 NumPasses;
+};
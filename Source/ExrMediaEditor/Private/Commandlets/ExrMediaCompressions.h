@@ -0,0 +1,79 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/UnrealString.h"
+#include "OpenExrWrapper.h"
+
+
+/**
+ * An EXR compression along with its command line name.
+ */
+struct FExrMediaCompressionEntry
+{
+	/** Name of the compression on the command line. */
+	const TCHAR* Name;
+
+	/** The compression. */
+	EExrCompression Compression;
+
+	/** Whether the compression is lossless. */
+	bool Lossless;
+};
+
+
+/** Compressions known to the commandlets, ordered from cheapest to most expensive to decode. */
+static const FExrMediaCompressionEntry ExrMediaCompressions[] =
+{
+	{ TEXT("None"), EExrCompression::None, true },
+	{ TEXT("Rle"), EExrCompression::Rle, true },
+	{ TEXT("Zips"), EExrCompression::Zips, true },
+	{ TEXT("Zip"), EExrCompression::Zip, true },
+	{ TEXT("Piz"), EExrCompression::Piz, true },
+	{ TEXT("Pxr24"), EExrCompression::Pxr24, false },
+	{ TEXT("B44"), EExrCompression::B44, false },
+	{ TEXT("B44a"), EExrCompression::B44a, false },
+	{ TEXT("Dwaa"), EExrCompression::Dwaa, false },
+	{ TEXT("Dwab"), EExrCompression::Dwab, false },
+};
+
+
+/**
+ * Get the command line name of the specified compression.
+ *
+ * @param Compression The compression.
+ * @return Compression name.
+ */
+inline const TCHAR* ExrMediaCompressionName(EExrCompression Compression)
+{
+	for (const FExrMediaCompressionEntry& Entry : ExrMediaCompressions)
+	{
+		if (Entry.Compression == Compression)
+		{
+			return Entry.Name;
+		}
+	}
+
+	return TEXT("Unknown");
+}
+
+
+/**
+ * Get the compression with the specified command line name (case insensitive).
+ *
+ * @param Name The compression name.
+ * @return The compression, or EExrCompression::Unknown if the name is unknown.
+ */
+inline EExrCompression ExrMediaParseCompression(const FString& Name)
+{
+	for (const FExrMediaCompressionEntry& Entry : ExrMediaCompressions)
+	{
+		if (Name == Entry.Name)
+		{
+			return Entry.Compression;
+		}
+	}
+
+	return EExrCompression::Unknown;
+}
@@ -0,0 +1,67 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "ExrMediaPakCommandlet.h"
+
+#include "IExrMediaModule.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+
+
+DEFINE_LOG_CATEGORY_STATIC(LogExrMediaPakCommandlet, Log, All);
+
+
+/* UExrMediaPakCommandlet structors
+ *****************************************************************************/
+
+UExrMediaPakCommandlet::UExrMediaPakCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+
+/* UCommandlet interface
+ *****************************************************************************/
+
+int32 UExrMediaPakCommandlet::Main(const FString& Params)
+{
+	FString SequencePath;
+
+	if (!FParse::Value(*Params, TEXT("Sequence="), SequencePath))
+	{
+		UE_LOG(LogExrMediaPakCommandlet, Error, TEXT("Usage: -run=ExrMediaPak -Sequence=<SequenceDirectory> [-Output=<ContainerFile>]"));
+		return 1;
+	}
+
+	FPaths::NormalizeDirectoryName(SequencePath);
+
+	FString ContainerPath;
+
+	if (!FParse::Value(*Params, TEXT("Output="), ContainerPath))
+	{
+		ContainerPath = SequencePath + TEXT(".exrpak");
+	}
+
+	// the media module is not loaded automatically in commandlets
+	IExrMediaModule* ExrMediaModule = FModuleManager::LoadModulePtr<IExrMediaModule>("ExrMedia");
+
+	if (ExrMediaModule == nullptr)
+	{
+		UE_LOG(LogExrMediaPakCommandlet, Error, TEXT("Failed to load the ExrMedia module"));
+		return 1;
+	}
+
+	UE_LOG(LogExrMediaPakCommandlet, Display, TEXT("Packing %s into %s"), *SequencePath, *ContainerPath);
+
+	if (!ExrMediaModule->PackSequence(SequencePath, ContainerPath))
+	{
+		UE_LOG(LogExrMediaPakCommandlet, Error, TEXT("Failed to pack %s"), *SequencePath);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,29 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "UObject/ObjectMacros.h"
+
+#include "ExrMediaPakCommandlet.generated.h"
+
+
+/**
+ * Packs an EXR image sequence into a single sequence container file.
+ *
+ * Usage: -run=ExrMediaPak -Sequence=<SequenceDirectory> [-Output=<ContainerFile>]
+ *
+ * The container file is written next to the sequence directory if no output is specified.
+ */
+UCLASS()
+class UExrMediaPakCommandlet
+	: public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	//~ UCommandlet interface
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,373 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "ExrMediaTranscodeCommandlet.h"
+
+#include "AssetRegistryModule.h"
+#include "Async/ParallelFor.h"
+#include "ExrMediaCompressions.h"
+#include "ExrMediaSource.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Misc/PackageName.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+#include "UObject/Package.h"
+
+
+DEFINE_LOG_CATEGORY_STATIC(LogExrMediaTranscodeCommandlet, Log, All);
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/**
+ * Check whether a transcoded copy of an image file would hold all of its image data.
+ *
+ * Transcoded images only have half-float RGBA channels in a single part, and
+ * their data window starts at the origin, so the image must not have anything
+ * beyond that.
+ *
+ * @param ImagePath Path to the image file.
+ * @param OutReason Will contain the reason if the image cannot be transcoded without loss.
+ * @return true if the transcoded copy is complete, false otherwise.
+ */
+static bool ExrMediaIsTranscodable(const FString& ImagePath, FString& OutReason)
+{
+	FMultiPartInputFile InputFile(ImagePath);
+
+	if (!InputFile.IsValid())
+	{
+		OutReason = TEXT("it is not a valid EXR image");
+		return false;
+	}
+
+	if (InputFile.GetNumParts() > 1)
+	{
+		OutReason = FString::Printf(TEXT("it has %i parts"), InputFile.GetNumParts());
+		return false;
+	}
+
+	if (InputFile.GetDataWindowOrigin(0) != FIntPoint::ZeroValue)
+	{
+		OutReason = TEXT("its data window does not start at the origin");
+		return false;
+	}
+
+	// luminance/chroma channels are converted to RGB by OpenEXR
+	static const TArray<FString> RgbaNames = { TEXT("R"), TEXT("G"), TEXT("B"), TEXT("A"), TEXT("Y"), TEXT("RY"), TEXT("BY") };
+
+	TArray<FString> ChannelNames;
+	InputFile.GetChannelNames(0, ChannelNames);
+
+	for (const FString& ChannelName : ChannelNames)
+	{
+		if (!RgbaNames.Contains(ChannelName))
+		{
+			OutReason = FString::Printf(TEXT("it has channel %s, which is not part of RGBA"), *ChannelName);
+			return false;
+		}
+	}
+
+	// float and integer channels would be converted to half precision
+	if (!InputFile.HasHalfChannels(0))
+	{
+		OutReason = TEXT("it has channels that are not half-float");
+		return false;
+	}
+
+	return true;
+}
+
+
+/** Decode an image file, and return the time it took (in seconds, or a negative value on failure). */
+static double ExrMediaDecodeFile(const FString& ImagePath, TArray<uint16>& OutPixels, FIntPoint& OutDim, double& OutFramesPerSecond)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	FRgbaInputFile InputFile(ImagePath, 0);
+
+	if (!InputFile.IsValid())
+	{
+		return -1.0;
+	}
+
+	OutDim = InputFile.GetDataWindow();
+	OutFramesPerSecond = InputFile.GetFramesPerSecond(0.0);
+
+	if (OutDim.GetMin() <= 0)
+	{
+		return -1.0;
+	}
+
+	OutPixels.SetNumUninitialized(OutDim.X * OutDim.Y * 4);
+
+	if (!InputFile.SetFrameBuffer(OutPixels.GetData(), OutDim) || !InputFile.ReadPixels(0, OutDim.Y - 1))
+	{
+		return -1.0;
+	}
+
+	return FPlatformTime::Seconds() - StartTime;
+}
+
+
+/** Transcode a single image file. */
+static bool ExrMediaTranscodeFile(const FString& InputPath, const FString& OutputPath, EExrCompression Compression)
+{
+	TArray<uint16> Pixels;
+	FIntPoint Dim;
+	double FramesPerSecond;
+
+	if (ExrMediaDecodeFile(InputPath, Pixels, Dim, FramesPerSecond) < 0.0)
+	{
+		return false;
+	}
+
+	FRgbaOutputFile OutputFile(OutputPath, Dim, Compression, FramesPerSecond, 0);
+
+	if (!OutputFile.IsValid())
+	{
+		return false;
+	}
+
+	OutputFile.SetFrameBuffer(Pixels.GetData(), Dim);
+
+	return OutputFile.WritePixels(Dim.Y);
+}
+
+
+/* UExrMediaTranscodeCommandlet structors
+ *****************************************************************************/
+
+UExrMediaTranscodeCommandlet::UExrMediaTranscodeCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+	, ForcedCompression(EExrCompression::Unknown)
+	, MaxSizeRatio(2.0f)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+
+/* UCommandlet interface
+ *****************************************************************************/
+
+int32 UExrMediaTranscodeCommandlet::Main(const FString& Params)
+{
+	FString CompressionName;
+
+	if (FParse::Value(*Params, TEXT("Compression="), CompressionName))
+	{
+		ForcedCompression = ExrMediaParseCompression(CompressionName);
+
+		if (ForcedCompression == EExrCompression::Unknown)
+		{
+			UE_LOG(LogExrMediaTranscodeCommandlet, Error, TEXT("Unknown compression %s"), *CompressionName);
+			return 1;
+		}
+	}
+
+	FParse::Value(*Params, TEXT("MaxSizeRatio="), MaxSizeRatio);
+
+	FString Suffix = TEXT("_Fast");
+	FParse::Value(*Params, TEXT("Suffix="), Suffix);
+
+	// transcode a single sequence
+	FString SequencePath;
+
+	if (FParse::Value(*Params, TEXT("Sequence="), SequencePath))
+	{
+		FPaths::NormalizeDirectoryName(SequencePath);
+
+		return TranscodeSequence(SequencePath, SequencePath + Suffix) ? 0 : 1;
+	}
+
+	// transcode the sequences of all media source assets
+	FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
+	AssetRegistryModule.Get().SearchAllAssets(true);
+
+	TArray<FAssetData> Assets;
+	AssetRegistryModule.Get().GetAssetsByClass(UExrMediaSource::StaticClass()->GetFName(), Assets);
+
+	const bool UpdateAssets = FParse::Param(*Params, TEXT("UpdateAssets"));
+	int32 NumFailed = 0;
+
+	for (const FAssetData& Asset : Assets)
+	{
+		UExrMediaSource* MediaSource = Cast<UExrMediaSource>(Asset.GetAsset());
+
+		if (MediaSource == nullptr)
+		{
+			continue;
+		}
+
+		// the source's URL holds its full sequence path
+		FString FullPath = MediaSource->GetUrl().RightChop(6);
+		FPaths::NormalizeDirectoryName(FullPath);
+
+		if (FullPath.EndsWith(Suffix))
+		{
+			UE_LOG(LogExrMediaTranscodeCommandlet, Display, TEXT("Skipping %s, which already plays a transcoded sequence"), *Asset.ObjectPath.ToString());
+			continue;
+		}
+
+		// assets must not be changed to play a copy that lost some of the image data
+		if (UpdateAssets && !IsSequenceTranscodable(FullPath))
+		{
+			UE_LOG(LogExrMediaTranscodeCommandlet, Error, TEXT("Skipping %s, because its sequence cannot be transcoded without loss"), *Asset.ObjectPath.ToString());
+			++NumFailed;
+			continue;
+		}
+
+		const FString OutputPath = FullPath + Suffix;
+
+		if (!TranscodeSequence(FullPath, OutputPath))
+		{
+			++NumFailed;
+			continue;
+		}
+
+		if (UpdateAssets)
+		{
+			// SetSequencePath expects a path to a file inside the sequence directory
+			MediaSource->SetSequencePath(OutputPath / TEXT(""));
+			MediaSource->MarkPackageDirty();
+
+			UPackage* Package = MediaSource->GetOutermost();
+			const FString PackageFilename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+
+			if (!UPackage::SavePackage(Package, nullptr, RF_Standalone, *PackageFilename, GError, nullptr, false, true, SAVE_NoError))
+			{
+				UE_LOG(LogExrMediaTranscodeCommandlet, Error, TEXT("Failed to save %s"), *PackageFilename);
+				++NumFailed;
+			}
+		}
+	}
+
+	UE_LOG(LogExrMediaTranscodeCommandlet, Display, TEXT("Transcoded %i of %i sequences"), Assets.Num() - NumFailed, Assets.Num());
+
+	return (NumFailed == 0) ? 0 : 1;
+}
+
+
+/* UExrMediaTranscodeCommandlet implementation
+ *****************************************************************************/
+
+bool UExrMediaTranscodeCommandlet::IsSequenceTranscodable(const FString& SequencePath) const
+{
+	TArray<FString> FileNames;
+	IFileManager::Get().FindFiles(FileNames, *(SequencePath / TEXT("*.exr")), true, false);
+
+	if (FileNames.Num() == 0)
+	{
+		UE_LOG(LogExrMediaTranscodeCommandlet, Error, TEXT("The directory %s does not contain any .exr image files"), *SequencePath);
+		return false;
+	}
+
+	FileNames.Sort();
+
+	// every frame is checked, since any of them may differ from the first
+	for (const FString& FileName : FileNames)
+	{
+		FString Reason;
+
+		if (!ExrMediaIsTranscodable(SequencePath / FileName, Reason))
+		{
+			UE_LOG(LogExrMediaTranscodeCommandlet, Error, TEXT("%s cannot be transcoded without loss, because %s"), *(SequencePath / FileName), *Reason);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+EExrCompression UExrMediaTranscodeCommandlet::SelectCompression(const FString& SamplePath, const FString& TempPath) const
+{
+	const int64 MaxSize = (int64)(IFileManager::Get().FileSize(*SamplePath) * MaxSizeRatio);
+
+	EExrCompression Fastest = EExrCompression::Unknown;
+	double FastestTime = 0.0;
+	EExrCompression Smallest = EExrCompression::None;
+	int64 SmallestSize = MAX_int64;
+
+	for (const FExrMediaCompressionEntry& Entry : ExrMediaCompressions)
+	{
+		// only lossless compressions are selected automatically
+		if (!Entry.Lossless || !ExrMediaTranscodeFile(SamplePath, TempPath, Entry.Compression))
+		{
+			continue;
+		}
+
+		TArray<uint16> Pixels;
+		FIntPoint Dim;
+		double FramesPerSecond;
+
+		const int64 Size = IFileManager::Get().FileSize(*TempPath);
+		const double DecodeTime = ExrMediaDecodeFile(TempPath, Pixels, Dim, FramesPerSecond);
+
+		UE_LOG(LogExrMediaTranscodeCommandlet, Display, TEXT("    %s: %.2f MB, %.2f ms"), Entry.Name, Size / (1024.0 * 1024.0), DecodeTime * 1000.0);
+
+		if (Size < SmallestSize)
+		{
+			Smallest = Entry.Compression;
+			SmallestSize = Size;
+		}
+
+		if ((Size <= MaxSize) && ((Fastest == EExrCompression::Unknown) || (DecodeTime < FastestTime)))
+		{
+			Fastest = Entry.Compression;
+			FastestTime = DecodeTime;
+		}
+	}
+
+	IFileManager::Get().Delete(*TempPath);
+
+	// fall back to the smallest candidate if none fits
+	return (Fastest != EExrCompression::Unknown) ? Fastest : Smallest;
+}
+
+
+bool UExrMediaTranscodeCommandlet::TranscodeSequence(const FString& SequencePath, const FString& OutputPath) const
+{
+	TArray<FString> FileNames;
+	IFileManager::Get().FindFiles(FileNames, *(SequencePath / TEXT("*.exr")), true, false);
+
+	if (FileNames.Num() == 0)
+	{
+		UE_LOG(LogExrMediaTranscodeCommandlet, Error, TEXT("The directory %s does not contain any .exr image files"), *SequencePath);
+		return false;
+	}
+
+	FileNames.Sort();
+
+	if (!IFileManager::Get().MakeDirectory(*OutputPath, true))
+	{
+		UE_LOG(LogExrMediaTranscodeCommandlet, Error, TEXT("Failed to create directory %s"), *OutputPath);
+		return false;
+	}
+
+	UE_LOG(LogExrMediaTranscodeCommandlet, Display, TEXT("Transcoding %i frames from %s to %s"), FileNames.Num(), *SequencePath, *OutputPath);
+
+	const EExrCompression Compression = (ForcedCompression != EExrCompression::Unknown)
+		? ForcedCompression
+		: SelectCompression(SequencePath / FileNames[0], OutputPath / TEXT("Transcode.tmp"));
+
+	UE_LOG(LogExrMediaTranscodeCommandlet, Display, TEXT("    Using %s compression"), ExrMediaCompressionName(Compression));
+
+	FThreadSafeCounter NumFailedFrames;
+
+	ParallelFor(FileNames.Num(), [&](int32 FrameIndex)
+	{
+		if (!ExrMediaTranscodeFile(SequencePath / FileNames[FrameIndex], OutputPath / FileNames[FrameIndex], Compression))
+		{
+			UE_LOG(LogExrMediaTranscodeCommandlet, Error, TEXT("Failed to transcode %s"), *FileNames[FrameIndex]);
+			NumFailedFrames.Increment();
+		}
+	});
+
+	return (NumFailedFrames.GetValue() == 0);
+}
@@ -0,0 +1,78 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "OpenExrWrapper.h"
+#include "UObject/ObjectMacros.h"
+
+#include "ExrMediaTranscodeCommandlet.generated.h"
+
+
+/**
+ * Transcodes EXR image sequences into a compression that is cheap to decode.
+ *
+ * Usage: -run=ExrMediaTranscode [-Sequence=<SequenceDirectory>] [-Compression=<Name>]
+ *        [-MaxSizeRatio=<Ratio>] [-Suffix=<Suffix>] [-UpdateAssets]
+ *
+ * Without -Sequence, the sequences of all EXR media source assets are transcoded.
+ * Transcoded sequences are written next to the original sequence directories, with
+ * the given suffix appended to the directory name (_Fast by default). If -UpdateAssets
+ * is specified, the media source assets are changed to play the transcoded sequences.
+ * Transcoded images hold half-float RGBA channels at the origin only, so with -UpdateAssets,
+ * sequences with other channels, non-half pixel types, layers, parts or a shifted data
+ * window in any frame are skipped.
+ *
+ * Unless a compression is forced with -Compression (None, Rle, Zips, Zip, Piz, ...), the
+ * first frame of each sequence is encoded with all candidate compressions, and the one
+ * that decodes fastest while growing the sequence by no more than MaxSizeRatio (2.0 by
+ * default) is chosen. Frames are transcoded in parallel.
+ */
+UCLASS()
+class UExrMediaTranscodeCommandlet
+	: public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	//~ UCommandlet interface
+
+	virtual int32 Main(const FString& Params) override;
+
+protected:
+
+	/**
+	 * Check whether all image files of a sequence can be transcoded without losing image data.
+	 *
+	 * @param SequencePath Path to the image sequence directory.
+	 * @return true if the transcoded sequence would be complete, false otherwise.
+	 */
+	bool IsSequenceTranscodable(const FString& SequencePath) const;
+
+	/**
+	 * Pick the compression that decodes fastest within the size limit.
+	 *
+	 * @param SamplePath Path to the image file to evaluate the candidates with.
+	 * @param TempPath Path to a temporary file to encode the candidates into.
+	 * @return The selected compression.
+	 */
+	EExrCompression SelectCompression(const FString& SamplePath, const FString& TempPath) const;
+
+	/**
+	 * Transcode all image files of a sequence.
+	 *
+	 * @param SequencePath Path to the image sequence directory.
+	 * @param OutputPath Path to the directory to write the transcoded sequence to.
+	 * @return true on success, false otherwise.
+	 */
+	bool TranscodeSequence(const FString& SequencePath, const FString& OutputPath) const;
+
+private:
+
+	/** The compression to transcode to (Unknown = select automatically). */
+	EExrCompression ForcedCompression;
+
+	/** Maximum size of the transcoded sequence relative to the original. */
+	float MaxSizeRatio;
+};
@@ -4,4 +4,12 @@
 
 
 UExrMediaSettings::UExrMediaSettings()
+	: AdaptiveQuality(true)
+	, CacheSizeMB(4096)
+	, DecoderThreads(0)
+	, DirectChannelDecoding(true)
+	, IntraFrameThreads(0)
+	, MemoryMappedFiles(false)
+	, SeekPreviews(false)
+	, StripedDecoding(false)
 { }
@@ -102,6 +102,7 @@ public:
 	{
 		// supported file extensions
 		SupportedFileExtensions.Add(TEXT("exr"));
+		SupportedFileExtensions.Add(TEXT("exrpak"));
 
 		// supported platforms
 		SupportedPlatforms.Add(TEXT("Linux"));
@@ -110,6 +111,7 @@ public:
 
 		// supported schemes
 		SupportedUriSchemes.Add(TEXT("exr"));
+		SupportedUriSchemes.Add(TEXT("exrpak"));
 
 #if WITH_EDITOR
 		// register settings
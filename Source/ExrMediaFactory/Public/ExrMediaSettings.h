@@ -8,6 +8,9 @@
 #include "ExrMediaSettings.generated.h"
 
 
+/**
+ * Settings for the ExrMedia plug-in.
+ */
 UCLASS(config=Engine)
 class EXRMEDIAFACTORY_API UExrMediaSettings
 	: public UObject
@@ -18,4 +21,81 @@ public:
 	 
 	/** Default constructor. */
 	UExrMediaSettings();
+
+public:
+
+	/**
+	 * Whether playback quality is reduced automatically when decoding cannot keep up with the frame rate.
+	 *
+	 * The player then skips every other frame or plays the sequence at a lower proxy resolution, and
+	 * returns to higher quality once decoding has enough headroom again.
+	 */
+	UPROPERTY(config, EditAnywhere, Category=Playback)
+	bool AdaptiveQuality;
+
+	/**
+	 * Maximum amount of memory used to cache decoded frames (in megabytes).
+	 *
+	 * The budget is shared by all players, and split evenly among the sequences that are open.
+	 */
+	UPROPERTY(config, EditAnywhere, Category=Caching, meta=(ClampMin="1"))
+	int32 CacheSizeMB;
+
+	/**
+	 * Whether half-float RGB(A) sequences are decoded straight into the frame buffer.
+	 *
+	 * This bypasses OpenEXR's RGBA conversion layer and its temporary buffers. Sequences with other
+	 * channel layouts, such as luminance/chroma or float images, always use the conversion layer.
+	 */
+	UPROPERTY(config, EditAnywhere, Category=Decoding)
+	bool DirectChannelDecoding;
+
+	/**
+	 * Number of image sequence frames to decode in parallel (0 = number of logical cores minus one).
+	 *
+	 * The decoder threads are shared by all players. Frames that are due soonest are decoded first,
+	 * and players that decode fewer frames than their share of the threads take precedence.
+	 */
+	UPROPERTY(config, EditAnywhere, Category=Decoding, meta=(ClampMin="0"))
+	int32 DecoderThreads;
+
+	/**
+	 * Number of threads that OpenEXR uses to decompress the line blocks of a single frame (0 = number of logical cores).
+	 *
+	 * These threads are used for frames that are needed immediately, i.e. after seeking or while scrubbing
+	 * a paused sequence. Frames that are decoded ahead of time are decoded by a single decoder thread each
+	 * and never use these threads. OpenEXR's thread pool is global to the process, so this setting also
+	 * applies to any other code that reads or writes EXR images through OpenEXR. It takes effect when the
+	 * first player is created.
+	 */
+	UPROPERTY(config, EditAnywhere, Category=Decoding, meta=(ClampMin="0"))
+	int32 IntraFrameThreads;
+
+	/**
+	 * Whether image files are memory mapped instead of read through file handles.
+	 *
+	 * Compressed line blocks are then decompressed straight from the mapped pages, which saves a copy and
+	 * a system call per line block. Image files must not be truncated while they are being played.
+	 */
+	UPROPERTY(config, EditAnywhere, Category=Decoding)
+	bool MemoryMappedFiles;
+
+	/**
+	 * Whether a low resolution preview of the target frame is displayed right after seeking.
+	 *
+	 * Previews are only decoded from tiled images with mip levels and from scan line images with one
+	 * line per block, where they cost a fraction of the full frame. The full frame replaces the preview.
+	 */
+	UPROPERTY(config, EditAnywhere, Category=Playback)
+	bool SeekPreviews;
+
+	/**
+	 * Whether frames that are needed immediately are split into horizontal stripes that are decoded in parallel.
+	 *
+	 * Each stripe is decoded with its own file handle on the task graph rather than OpenEXR's thread pool, one
+	 * stripe per logical core, or per intra-frame thread if IntraFrameThreads is set. This usually has lower
+	 * latency than OpenEXR's own threading for very large frames, but opens the same file several times.
+	 */
+	UPROPERTY(config, EditAnywhere, Category=Decoding)
+	bool StripedDecoding;
 };
@@ -6,6 +6,7 @@ namespace UnrealBuildTool.Rules
 	{
 		public OpenExrWrapper(ReadOnlyTargetRules Target) : base(Target)
 		{
+            bEnableExceptions = true;
             bUseRTTI = true;
             PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
@@ -13,7 +14,8 @@ namespace UnrealBuildTool.Rules
 
             if ((Target.Platform == UnrealTargetPlatform.Win64) ||
                 (Target.Platform == UnrealTargetPlatform.Win32) ||
-                (Target.Platform == UnrealTargetPlatform.Mac))
+                (Target.Platform == UnrealTargetPlatform.Mac) ||
+                (Target.Platform == UnrealTargetPlatform.Linux))
             {
                 AddEngineThirdPartyPrivateStaticDependencies(Target, "UEOpenExr");
                 AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
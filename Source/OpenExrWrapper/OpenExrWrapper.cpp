@@ -1,26 +1,648 @@
-#pragma warning(push)
-#pragma warning(disable:28251)
+#ifdef _MSC_VER
+	#pragma warning(push)
+	#pragma warning(disable:28251)
+#endif
 
 #include "OpenExrWrapper.h"
 
 #include "Containers/UnrealString.h"
+#include "Math/UnrealMathUtility.h"
 #include "Modules/ModuleManager.h"
+#include "Stats/Stats.h"
 
+#if PLATFORM_WINDOWS
+	#include "WindowsHWrapper.h"
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#include <exception>
+
+#include "Iex.h"
 #include "ImathBox.h"
+#include "ImfChannelList.h"
+#include "ImfCompression.h"
+#include "ImfFrameBuffer.h"
 #include "ImfHeader.h"
+#include "ImfInputFile.h"
+#include "ImfInputPart.h"
+#include "ImfIO.h"
+#include "ImfMultiPartInputFile.h"
 #include "ImfRgbaFile.h"
 #include "ImfStandardAttributes.h"
+#include "ImfThreading.h"
+#include "ImfTiledRgbaFile.h"
+
+
+DECLARE_STATS_GROUP(TEXT("OpenExrWrapper"), STATGROUP_OpenExrWrapper, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("Map File"), STAT_OpenExrWrapper_MapFile, STATGROUP_OpenExrWrapper);
+DECLARE_CYCLE_STAT(TEXT("Open Input File"), STAT_OpenExrWrapper_OpenInputFile, STATGROUP_OpenExrWrapper);
+DECLARE_CYCLE_STAT(TEXT("Read Chunk"), STAT_OpenExrWrapper_ReadChunk, STATGROUP_OpenExrWrapper);
+DECLARE_CYCLE_STAT(TEXT("Read Pixels"), STAT_OpenExrWrapper_ReadPixels, STATGROUP_OpenExrWrapper);
+
+DEFINE_LOG_CATEGORY_STATIC(LogOpenExrWrapper, Log, All);
+
+
+/* Local helpers
+ *****************************************************************************/
+
+/**
+ * Log an exception that OpenEXR threw while accessing a file.
+ *
+ * OpenEXR reports malformed and truncated files with exceptions, which must not
+ * leave the wrapper, so every call into OpenEXR that reads the file catches them.
+ */
+static void ExrLogException(const TCHAR* Action, const FString& FilePath, const std::exception& Exception)
+{
+	UE_LOG(LogOpenExrWrapper, Warning, TEXT("Failed to %s %s: %s"), Action, *FilePath, ANSI_TO_TCHAR(Exception.what()));
+}
+
+
+/* FExrMemoryStream
+ *****************************************************************************/
+
+/**
+ * Implements an OpenEXR input stream for a memory mapped file.
+ *
+ * The stream reports itself as memory mapped, so that OpenEXR reads compressed
+ * line blocks straight from the mapped pages instead of copying them into an
+ * intermediate buffer first.
+ */
+class FExrMemoryStream
+	: public Imf::IStream
+{
+public:
+
+	FExrMemoryStream(const char* FileName, const uint8* InData, int64 InSize)
+		: Imf::IStream(FileName)
+		, Data((const char*)InData)
+		, Position(0)
+		, Size(InSize)
+	{ }
+
+public:
+
+	//~ Imf::IStream interface
+
+	virtual bool isMemoryMapped() const override
+	{
+		return true;
+	}
+
+	virtual bool read(char Buffer[], int Count) override
+	{
+		SCOPE_CYCLE_COUNTER(STAT_OpenExrWrapper_ReadChunk);
+
+		if (Count > Size - Position)
+		{
+			throw Iex::InputExc("Unexpected end of file.");
+		}
+
+		FMemory::Memcpy(Buffer, Data + Position, Count);
+		Position += Count;
+
+		return (Position < Size);
+	}
+
+	virtual char* readMemoryMapped(int Count) override
+	{
+		if (Count > Size - Position)
+		{
+			throw Iex::InputExc("Unexpected end of file.");
+		}
+
+		const char* Result = Data + Position;
+		Position += Count;
+
+		return const_cast<char*>(Result);
+	}
+
+	virtual Imf::Int64 tellg() override
+	{
+		return Position;
+	}
+
+	virtual void seekg(Imf::Int64 Pos) override
+	{
+		Position = Pos;
+	}
+
+private:
+
+	const char* Data;
+	int64 Position;
+	int64 Size;
+};
+
+
+/* FExrMappedFile
+ *****************************************************************************/
+
+FExrMappedFile::FExrMappedFile(const FString& InFilePath)
+	: Data(nullptr)
+	, FilePath(InFilePath)
+	, OwnsMapping(true)
+	, Size(0)
+{
+	SCOPE_CYCLE_COUNTER(STAT_OpenExrWrapper_MapFile);
+
+#if PLATFORM_WINDOWS
+	HANDLE File = ::CreateFileW(*FilePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (File == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+
+	LARGE_INTEGER FileSize;
+
+	if (::GetFileSizeEx(File, &FileSize) && (FileSize.QuadPart > 0))
+	{
+		HANDLE Mapping = ::CreateFileMappingW(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (Mapping != nullptr)
+		{
+			Data = (const uint8*)::MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+			Size = (Data != nullptr) ? FileSize.QuadPart : 0;
+
+			// the view keeps the mapping alive
+			::CloseHandle(Mapping);
+		}
+	}
+
+	::CloseHandle(File);
+#else
+	const int File = ::open(TCHAR_TO_UTF8(*FilePath), O_RDONLY);
+
+	if (File == -1)
+	{
+		return;
+	}
+
+	struct stat FileStat;
+
+	if ((::fstat(File, &FileStat) == 0) && (FileStat.st_size > 0))
+	{
+		void* Mapping = ::mmap(nullptr, FileStat.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+
+		if (Mapping != MAP_FAILED)
+		{
+			::madvise(Mapping, FileStat.st_size, MADV_SEQUENTIAL);
+
+			Data = (const uint8*)Mapping;
+			Size = FileStat.st_size;
+		}
+	}
+
+	// the mapping keeps the file alive
+	::close(File);
+#endif
+}
+
+
+FExrMappedFile::FExrMappedFile(const FExrMappedFile& Container, int64 Offset, int64 InSize, const FString& InFilePath)
+	: Data(nullptr)
+	, FilePath(InFilePath)
+	, OwnsMapping(false)
+	, Size(0)
+{
+	// views reference a byte range of the container's mapping
+	if (Container.IsValid() && (Offset >= 0) && (InSize > 0) && (Offset + InSize <= Container.GetSize()))
+	{
+		Data = Container.GetData() + Offset;
+		Size = InSize;
+	}
+}
+
+
+FExrMappedFile::~FExrMappedFile()
+{
+	if ((Data == nullptr) || !OwnsMapping)
+	{
+		return;
+	}
+
+#if PLATFORM_WINDOWS
+	::UnmapViewOfFile(Data);
+#else
+	::munmap((void*)Data, Size);
+#endif
+}
+
+
+/* FChannelInputFile
+ *****************************************************************************/
+
+/** Get the header of a channel input file, or of its part if it reads a part other than the first. */
+static const Imf::Header& ExrGetHeader(void* InputFile, void* InputPart)
+{
+	return (InputPart != nullptr) ? ((Imf::InputPart*)InputPart)->header() : ((Imf::InputFile*)InputFile)->header();
+}
+
+
+/** Set the frame buffer of a channel input file, or of its part if it reads a part other than the first. */
+static bool ExrSetFrameBuffer(void* InputFile, void* InputPart, const Imf::FrameBuffer& FrameBuffer, const FString& FilePath)
+{
+	try
+	{
+		if (InputPart != nullptr)
+		{
+			((Imf::InputPart*)InputPart)->setFrameBuffer(FrameBuffer);
+		}
+		else
+		{
+			((Imf::InputFile*)InputFile)->setFrameBuffer(FrameBuffer);
+		}
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("set frame buffer of"), FilePath, Exception);
+		return false;
+	}
+
+	return true;
+}
+
+
+FChannelInputFile::FChannelInputFile(const FString& FilePath, int32 NumThreads)
+	: FChannelInputFile(FilePath, 0, NumThreads)
+{ }
+
+
+FChannelInputFile::FChannelInputFile(const FString& InFilePath, int32 Part, int32 NumThreads)
+	: FilePath(InFilePath)
+	, InputFile(nullptr)
+	, InputPart(nullptr)
+	, InputStream(nullptr)
+	, MultiPartFile(nullptr)
+{
+	SCOPE_CYCLE_COUNTER(STAT_OpenExrWrapper_OpenInputFile);
+
+	try
+	{
+		// parts other than the first are only accessible through a multi-part file
+		if (Part > 0)
+		{
+			MultiPartFile = new Imf::MultiPartInputFile(TCHAR_TO_ANSI(*FilePath), NumThreads);
+			InputPart = new Imf::InputPart(*(Imf::MultiPartInputFile*)MultiPartFile, Part);
+		}
+		else
+		{
+			InputFile = new Imf::InputFile(TCHAR_TO_ANSI(*FilePath), NumThreads);
+		}
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("open"), FilePath, Exception);
+		Close();
+	}
+}
+
+
+FChannelInputFile::FChannelInputFile(const FExrMappedFile& MappedFile, int32 NumThreads)
+	: FChannelInputFile(MappedFile, 0, NumThreads)
+{ }
+
+
+FChannelInputFile::FChannelInputFile(const FExrMappedFile& MappedFile, int32 Part, int32 NumThreads)
+	: FilePath(MappedFile.GetFilePath())
+	, InputFile(nullptr)
+	, InputPart(nullptr)
+	, InputStream(nullptr)
+	, MultiPartFile(nullptr)
+{
+	SCOPE_CYCLE_COUNTER(STAT_OpenExrWrapper_OpenInputFile);
+
+	InputStream = new FExrMemoryStream(TCHAR_TO_ANSI(*FilePath), MappedFile.GetData(), MappedFile.GetSize());
+
+	try
+	{
+		if (Part > 0)
+		{
+			MultiPartFile = new Imf::MultiPartInputFile(*(FExrMemoryStream*)InputStream, NumThreads);
+			InputPart = new Imf::InputPart(*(Imf::MultiPartInputFile*)MultiPartFile, Part);
+		}
+		else
+		{
+			InputFile = new Imf::InputFile(*(FExrMemoryStream*)InputStream, NumThreads);
+		}
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("open"), FilePath, Exception);
+		Close();
+	}
+}
+
+
+FChannelInputFile::~FChannelInputFile()
+{
+	Close();
+}
+
+
+FIntPoint FChannelInputFile::GetDataWindow() const
+{
+	Imath::Box2i Win = ExrGetHeader(InputFile, InputPart).dataWindow();
+
+	return FIntPoint(
+		Win.max.x - Win.min.x + 1,
+		Win.max.y - Win.min.y + 1
+	);
+}
+
+
+bool FChannelInputFile::IsValid() const
+{
+	return (InputFile != nullptr) || (InputPart != nullptr);
+}
+
+
+bool FChannelInputFile::ReadPixels(int32 StartY, int32 EndY)
+{
+	SCOPE_CYCLE_COUNTER(STAT_OpenExrWrapper_ReadPixels);
+
+	Imath::Box2i Win = ExrGetHeader(InputFile, InputPart).dataWindow();
+
+	// StartY and EndY are relative to the top of the data window
+	StartY = FMath::Clamp(Win.min.y + StartY, Win.min.y, Win.max.y);
+	EndY = FMath::Clamp(Win.min.y + EndY, Win.min.y, Win.max.y);
+
+	if (StartY > EndY)
+	{
+		return true;
+	}
+
+	try
+	{
+		if (InputPart != nullptr)
+		{
+			((Imf::InputPart*)InputPart)->readPixels(StartY, EndY);
+		}
+		else
+		{
+			((Imf::InputFile*)InputFile)->readPixels(StartY, EndY);
+		}
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("read pixels of"), FilePath, Exception);
+		return false;
+	}
+
+	return true;
+}
+
+
+bool FChannelInputFile::SetFrameBuffer(void* Buffer, const FIntPoint& BufferDim)
+{
+	Imath::Box2i Win = ExrGetHeader(InputFile, InputPart).dataWindow();
+
+	// the slices interleave into the same layout as Imf::Rgba
+	const size_t PixelStride = 4 * sizeof(half);
+	const size_t RowStride = PixelStride * BufferDim.X;
+	char* Base = (char*)Buffer - Win.min.x * PixelStride - Win.min.y * RowStride;
+
+	Imf::FrameBuffer FrameBuffer;
+	{
+		FrameBuffer.insert("R", Imf::Slice(Imf::HALF, Base + 0 * sizeof(half), PixelStride, RowStride, 1, 1, 0.0));
+		FrameBuffer.insert("G", Imf::Slice(Imf::HALF, Base + 1 * sizeof(half), PixelStride, RowStride, 1, 1, 0.0));
+		FrameBuffer.insert("B", Imf::Slice(Imf::HALF, Base + 2 * sizeof(half), PixelStride, RowStride, 1, 1, 0.0));
+		FrameBuffer.insert("A", Imf::Slice(Imf::HALF, Base + 3 * sizeof(half), PixelStride, RowStride, 1, 1, 1.0));
+	}
+
+	return ExrSetFrameBuffer(InputFile, InputPart, FrameBuffer, FilePath);
+}
+
+
+bool FChannelInputFile::SetFrameBuffer(void* Buffer, const FIntPoint& BufferDim, const TArray<FString>& ChannelNames)
+{
+	Imath::Box2i Win = ExrGetHeader(InputFile, InputPart).dataWindow();
+
+	// the slices interleave in the order of the given channel names
+	const size_t PixelStride = ChannelNames.Num() * sizeof(half);
+	const size_t RowStride = PixelStride * BufferDim.X;
+	char* Base = (char*)Buffer - Win.min.x * PixelStride - Win.min.y * RowStride;
+
+	Imf::FrameBuffer FrameBuffer;
+
+	for (int32 ChannelIndex = 0; ChannelIndex < ChannelNames.Num(); ++ChannelIndex)
+	{
+		// missing channels are filled with zero, except for the fourth (alpha) channel
+		const double FillValue = (ChannelIndex == 3) ? 1.0 : 0.0;
+		FrameBuffer.insert(TCHAR_TO_ANSI(*ChannelNames[ChannelIndex]), Imf::Slice(Imf::HALF, Base + ChannelIndex * sizeof(half), PixelStride, RowStride, 1, 1, FillValue));
+	}
+
+	return ExrSetFrameBuffer(InputFile, InputPart, FrameBuffer, FilePath);
+}
+
+
+void FChannelInputFile::Close()
+{
+	delete (Imf::InputPart*)InputPart;
+	delete (Imf::MultiPartInputFile*)MultiPartFile;
+	delete (Imf::InputFile*)InputFile;
+	delete (FExrMemoryStream*)InputStream;
+
+	InputFile = nullptr;
+	InputPart = nullptr;
+	InputStream = nullptr;
+	MultiPartFile = nullptr;
+}
+
 
+/* FMultiPartInputFile
+ *****************************************************************************/
 
-FRgbaInputFile::FRgbaInputFile(const FString& FilePath)
+FMultiPartInputFile::FMultiPartInputFile(const FString& FilePath)
+	: InputFile(nullptr)
 {
-	InputFile = new Imf::RgbaInputFile(TCHAR_TO_ANSI(*FilePath));
+	SCOPE_CYCLE_COUNTER(STAT_OpenExrWrapper_OpenInputFile);
+
+	try
+	{
+		InputFile = new Imf::MultiPartInputFile(TCHAR_TO_ANSI(*FilePath));
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("open"), FilePath, Exception);
+	}
+}
+
+
+FMultiPartInputFile::~FMultiPartInputFile()
+{
+	delete (Imf::MultiPartInputFile*)InputFile;
+}
+
+
+void FMultiPartInputFile::GetChannelNames(int32 Part, TArray<FString>& OutChannelNames) const
+{
+	const Imf::ChannelList& Channels = ((Imf::MultiPartInputFile*)InputFile)->header(Part).channels();
+
+	for (Imf::ChannelList::ConstIterator It = Channels.begin(); It != Channels.end(); ++It)
+	{
+		OutChannelNames.Add(ANSI_TO_TCHAR(It.name()));
+	}
+}
+
+
+FIntPoint FMultiPartInputFile::GetDataWindow(int32 Part) const
+{
+	Imath::Box2i Win = ((Imf::MultiPartInputFile*)InputFile)->header(Part).dataWindow();
+
+	return FIntPoint(
+		Win.max.x - Win.min.x + 1,
+		Win.max.y - Win.min.y + 1
+	);
+}
+
+
+FIntPoint FMultiPartInputFile::GetDataWindowOrigin(int32 Part) const
+{
+	Imath::Box2i Win = ((Imf::MultiPartInputFile*)InputFile)->header(Part).dataWindow();
+
+	return FIntPoint(Win.min.x, Win.min.y);
+}
+
+
+int32 FMultiPartInputFile::GetNumParts() const
+{
+	return ((Imf::MultiPartInputFile*)InputFile)->parts();
+}
+
+
+FString FMultiPartInputFile::GetPartName(int32 Part) const
+{
+	const Imf::Header& Header = ((Imf::MultiPartInputFile*)InputFile)->header(Part);
+
+	return Header.hasName() ? FString(ANSI_TO_TCHAR(Header.name().c_str())) : FString();
+}
+
+
+bool FMultiPartInputFile::HasHalfChannels(int32 Part) const
+{
+	const Imf::ChannelList& Channels = ((Imf::MultiPartInputFile*)InputFile)->header(Part).channels();
+
+	for (Imf::ChannelList::ConstIterator It = Channels.begin(); It != Channels.end(); ++It)
+	{
+		if (It.channel().type != Imf::HALF)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+bool FMultiPartInputFile::IsValid() const
+{
+	return (InputFile != nullptr);
+}
+
+
+/* FRgbaInputFile
+ *****************************************************************************/
+
+FRgbaInputFile::FRgbaInputFile(const FString& InFilePath)
+	: FilePath(InFilePath)
+	, InputFile(nullptr)
+	, InputStream(nullptr)
+{
+	SCOPE_CYCLE_COUNTER(STAT_OpenExrWrapper_OpenInputFile);
+
+	try
+	{
+		InputFile = new Imf::RgbaInputFile(TCHAR_TO_ANSI(*FilePath));
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("open"), FilePath, Exception);
+	}
+}
+
+
+FRgbaInputFile::FRgbaInputFile(const FString& InFilePath, int32 NumThreads)
+	: FilePath(InFilePath)
+	, InputFile(nullptr)
+	, InputStream(nullptr)
+{
+	SCOPE_CYCLE_COUNTER(STAT_OpenExrWrapper_OpenInputFile);
+
+	try
+	{
+		InputFile = new Imf::RgbaInputFile(TCHAR_TO_ANSI(*FilePath), NumThreads);
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("open"), FilePath, Exception);
+	}
+}
+
+
+FRgbaInputFile::FRgbaInputFile(const FExrMappedFile& MappedFile, int32 NumThreads)
+	: FilePath(MappedFile.GetFilePath())
+	, InputFile(nullptr)
+	, InputStream(nullptr)
+{
+	SCOPE_CYCLE_COUNTER(STAT_OpenExrWrapper_OpenInputFile);
+
+	InputStream = new FExrMemoryStream(TCHAR_TO_ANSI(*FilePath), MappedFile.GetData(), MappedFile.GetSize());
+
+	try
+	{
+		InputFile = new Imf::RgbaInputFile(*(FExrMemoryStream*)InputStream, NumThreads);
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("open"), FilePath, Exception);
+
+		// the stream must outlive the input file, so it is only freed on failure
+		delete (FExrMemoryStream*)InputStream;
+		InputStream = nullptr;
+	}
 }
 
 
 FRgbaInputFile::~FRgbaInputFile()
 {
 	delete (Imf::RgbaInputFile*)InputFile;
+	delete (FExrMemoryStream*)InputStream;
+}
+
+
+void FRgbaInputFile::GetChannelNames(TArray<FString>& OutChannelNames) const
+{
+	const Imf::ChannelList& Channels = ((Imf::RgbaInputFile*)InputFile)->header().channels();
+
+	for (Imf::ChannelList::ConstIterator It = Channels.begin(); It != Channels.end(); ++It)
+	{
+		OutChannelNames.Add(ANSI_TO_TCHAR(It.name()));
+	}
+}
+
+
+EExrCompression FRgbaInputFile::GetCompression() const
+{
+	switch (((Imf::RgbaInputFile*)InputFile)->compression())
+	{
+	case Imf::NO_COMPRESSION: return EExrCompression::None;
+	case Imf::RLE_COMPRESSION: return EExrCompression::Rle;
+	case Imf::ZIPS_COMPRESSION: return EExrCompression::Zips;
+	case Imf::ZIP_COMPRESSION: return EExrCompression::Zip;
+	case Imf::PIZ_COMPRESSION: return EExrCompression::Piz;
+	case Imf::PXR24_COMPRESSION: return EExrCompression::Pxr24;
+	case Imf::B44_COMPRESSION: return EExrCompression::B44;
+	case Imf::B44A_COMPRESSION: return EExrCompression::B44a;
+	case Imf::DWAA_COMPRESSION: return EExrCompression::Dwaa;
+	case Imf::DWAB_COMPRESSION: return EExrCompression::Dwab;
+	default: return EExrCompression::Unknown;
+	}
 }
 
 
@@ -48,20 +670,402 @@ double FRgbaInputFile::GetFramesPerSecond(double DefaultValue) const
 }
 
 
-void FRgbaInputFile::ReadPixels(int32 StartY, int32 EndY)
+int32 FRgbaInputFile::GetLinesPerBlock() const
+{
+	switch (((Imf::RgbaInputFile*)InputFile)->compression())
+	{
+	case Imf::NO_COMPRESSION:
+	case Imf::RLE_COMPRESSION:
+	case Imf::ZIPS_COMPRESSION:
+		return 1;
+
+	case Imf::ZIP_COMPRESSION:
+	case Imf::PXR24_COMPRESSION:
+		return 16;
+
+	case Imf::PIZ_COMPRESSION:
+	case Imf::B44_COMPRESSION:
+	case Imf::B44A_COMPRESSION:
+	case Imf::DWAA_COMPRESSION:
+		return 32;
+
+	case Imf::DWAB_COMPRESSION:
+		return 256;
+
+	default:
+		return 1;
+	}
+}
+
+
+FIntPoint FRgbaInputFile::GetMipDataWindow(int32 Level) const
+{
+	const Imf::Header& Header = ((Imf::RgbaInputFile*)InputFile)->header();
+	const FIntPoint Dim = GetDataWindow();
+
+	if ((Level <= 0) || !Header.hasTileDescription() || (Header.tileDescription().mode == Imf::ONE_LEVEL))
+	{
+		return Dim;
+	}
+
+	// same as Imf::TiledInputFile::dataWindowForLevel, but without reopening the image as a tiled file
+	const bool RoundUp = (Header.tileDescription().roundingMode == Imf::ROUND_UP);
+
+	const auto GetLevelSize = [Level, RoundUp](int32 Size) {
+		int32 LevelSize = Size >> Level;
+
+		if (RoundUp && ((LevelSize << Level) < Size))
+		{
+			++LevelSize;
+		}
+
+		return FMath::Max(1, LevelSize);
+	};
+
+	return FIntPoint(GetLevelSize(Dim.X), GetLevelSize(Dim.Y));
+}
+
+
+int32 FRgbaInputFile::GetNumMipLevels() const
 {
+	const Imf::Header& Header = ((Imf::RgbaInputFile*)InputFile)->header();
+
+	if (!Header.hasTileDescription() || (Header.tileDescription().mode == Imf::ONE_LEVEL))
+	{
+		return 1;
+	}
+
+	const Imath::Box2i& Win = Header.dataWindow();
+	const int32 Width = Win.max.x - Win.min.x + 1;
+	const int32 Height = Win.max.y - Win.min.y + 1;
+
+	// rip map levels are only used along the diagonal, which ends at the smaller side
+	const int32 Size = (Header.tileDescription().mode == Imf::RIPMAP_LEVELS) ? FMath::Min(Width, Height) : FMath::Max(Width, Height);
+	int32 NumLevels = FMath::FloorLog2(Size) + 1;
+
+	if ((Header.tileDescription().roundingMode == Imf::ROUND_UP) && !FMath::IsPowerOfTwo(Size))
+	{
+		++NumLevels;
+	}
+
+	return NumLevels;
+}
+
+
+bool FRgbaInputFile::HasHalfRgbaChannels() const
+{
+	const Imf::ChannelList& Channels = ((Imf::RgbaInputFile*)InputFile)->header().channels();
+
+	// luminance/chroma images have to be converted by Imf::RgbaInputFile
+	if ((Channels.findChannel("Y") != nullptr) || (Channels.findChannel("RY") != nullptr) || (Channels.findChannel("BY") != nullptr))
+	{
+		return false;
+	}
+
+	const char* RgbaNames[] = { "R", "G", "B", "A" };
+
+	for (const char* Name : RgbaNames)
+	{
+		const Imf::Channel* Channel = Channels.findChannel(Name);
+
+		// a missing alpha channel is filled in, but colors are required
+		if (Channel == nullptr)
+		{
+			if (Name[0] != 'A')
+			{
+				return false;
+			}
+		}
+		else if ((Channel->type != Imf::HALF) || (Channel->xSampling != 1) || (Channel->ySampling != 1))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+bool FRgbaInputFile::IsValid() const
+{
+	return (InputFile != nullptr);
+}
+
+
+bool FRgbaInputFile::ReadPixels(int32 StartY, int32 EndY)
+{
+	SCOPE_CYCLE_COUNTER(STAT_OpenExrWrapper_ReadPixels);
+
 	Imath::Box2i Win = ((Imf::RgbaInputFile*)InputFile)->dataWindow();
-	((Imf::RgbaInputFile*)InputFile)->readPixels(Win.min.y, Win.max.y);
+
+	// StartY and EndY are relative to the top of the data window
+	StartY = FMath::Clamp(Win.min.y + StartY, Win.min.y, Win.max.y);
+	EndY = FMath::Clamp(Win.min.y + EndY, Win.min.y, Win.max.y);
+
+	if (StartY > EndY)
+	{
+		return true;
+	}
+
+	try
+	{
+		((Imf::RgbaInputFile*)InputFile)->readPixels(StartY, EndY);
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("read pixels of"), FilePath, Exception);
+		return false;
+	}
+
+	return true;
 }
 
 
-void FRgbaInputFile::SetFrameBuffer(void* Buffer, const FIntPoint& BufferDim)
+bool FRgbaInputFile::SetFrameBuffer(void* Buffer, const FIntPoint& BufferDim)
 {
 	Imath::Box2i Win = ((Imf::RgbaInputFile*)InputFile)->dataWindow();
-	((Imf::RgbaInputFile*)InputFile)->setFrameBuffer((Imf::Rgba*)Buffer - Win.min.x - Win.min.y * BufferDim.X, 1, BufferDim.X);
+
+	try
+	{
+		((Imf::RgbaInputFile*)InputFile)->setFrameBuffer((Imf::Rgba*)Buffer - Win.min.x - Win.min.y * BufferDim.X, 1, BufferDim.X);
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("set frame buffer of"), FilePath, Exception);
+		return false;
+	}
+
+	return true;
+}
+
+
+int32 FRgbaInputFile::GetGlobalThreadCount()
+{
+	return Imf::globalThreadCount();
+}
+
+
+void FRgbaInputFile::SetGlobalThreadCount(int32 ThreadCount)
+{
+	Imf::setGlobalThreadCount(ThreadCount);
+}
+
+
+/* FRgbaOutputFile
+ *****************************************************************************/
+
+FRgbaOutputFile::FRgbaOutputFile(const FString& FilePath, const FIntPoint& Dim, EExrCompression Compression, double FramesPerSecond, int32 NumThreads)
+	: FRgbaOutputFile(FilePath, Dim, Compression, EExrRgbaChannels::Rgba, FramesPerSecond, NumThreads)
+{ }
+
+
+FRgbaOutputFile::FRgbaOutputFile(const FString& InFilePath, const FIntPoint& Dim, EExrCompression Compression, EExrRgbaChannels Channels, double FramesPerSecond, int32 NumThreads)
+	: FilePath(InFilePath)
+	, OutputFile(nullptr)
+{
+	Imf::Header Header(Dim.X, Dim.Y);
+
+	switch (Compression)
+	{
+	case EExrCompression::Rle: Header.compression() = Imf::RLE_COMPRESSION; break;
+	case EExrCompression::Zips: Header.compression() = Imf::ZIPS_COMPRESSION; break;
+	case EExrCompression::Zip: Header.compression() = Imf::ZIP_COMPRESSION; break;
+	case EExrCompression::Piz: Header.compression() = Imf::PIZ_COMPRESSION; break;
+	case EExrCompression::Pxr24: Header.compression() = Imf::PXR24_COMPRESSION; break;
+	case EExrCompression::B44: Header.compression() = Imf::B44_COMPRESSION; break;
+	case EExrCompression::B44a: Header.compression() = Imf::B44A_COMPRESSION; break;
+	case EExrCompression::Dwaa: Header.compression() = Imf::DWAA_COMPRESSION; break;
+	case EExrCompression::Dwab: Header.compression() = Imf::DWAB_COMPRESSION; break;
+	default: Header.compression() = Imf::NO_COMPRESSION;
+	}
+
+	if (FramesPerSecond > 0.0)
+	{
+		Imf::addFramesPerSecond(Header, Imf::Rational(FramesPerSecond));
+	}
+
+	Imf::RgbaChannels RgbaChannels;
+
+	switch (Channels)
+	{
+	case EExrRgbaChannels::Rgb: RgbaChannels = Imf::WRITE_RGB; break;
+	case EExrRgbaChannels::Ya: RgbaChannels = Imf::WRITE_YA; break;
+	case EExrRgbaChannels::Y: RgbaChannels = Imf::WRITE_Y; break;
+	default: RgbaChannels = Imf::WRITE_RGBA;
+	}
+
+	try
+	{
+		OutputFile = new Imf::RgbaOutputFile(TCHAR_TO_ANSI(*FilePath), Header, RgbaChannels, NumThreads);
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("create"), FilePath, Exception);
+	}
+}
+
+
+FRgbaOutputFile::~FRgbaOutputFile()
+{
+	delete (Imf::RgbaOutputFile*)OutputFile;
+}
+
+
+bool FRgbaOutputFile::IsValid() const
+{
+	return (OutputFile != nullptr);
+}
+
+
+void FRgbaOutputFile::SetFrameBuffer(const void* Buffer, const FIntPoint& BufferDim)
+{
+	((Imf::RgbaOutputFile*)OutputFile)->setFrameBuffer((const Imf::Rgba*)Buffer, 1, BufferDim.X);
+}
+
+
+bool FRgbaOutputFile::WritePixels(int32 NumScanLines)
+{
+	try
+	{
+		((Imf::RgbaOutputFile*)OutputFile)->writePixels(NumScanLines);
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("write pixels of"), FilePath, Exception);
+		return false;
+	}
+
+	return true;
+}
+
+
+/* FTiledRgbaInputFile
+ *****************************************************************************/
+
+FTiledRgbaInputFile::FTiledRgbaInputFile(const FString& InFilePath, int32 NumThreads)
+	: FilePath(InFilePath)
+	, InputFile(nullptr)
+	, InputStream(nullptr)
+{
+	SCOPE_CYCLE_COUNTER(STAT_OpenExrWrapper_OpenInputFile);
+
+	try
+	{
+		InputFile = new Imf::TiledRgbaInputFile(TCHAR_TO_ANSI(*FilePath), NumThreads);
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("open"), FilePath, Exception);
+	}
+}
+
+
+FTiledRgbaInputFile::FTiledRgbaInputFile(const FExrMappedFile& MappedFile, int32 NumThreads)
+	: FilePath(MappedFile.GetFilePath())
+	, InputFile(nullptr)
+	, InputStream(nullptr)
+{
+	SCOPE_CYCLE_COUNTER(STAT_OpenExrWrapper_OpenInputFile);
+
+	InputStream = new FExrMemoryStream(TCHAR_TO_ANSI(*FilePath), MappedFile.GetData(), MappedFile.GetSize());
+
+	try
+	{
+		InputFile = new Imf::TiledRgbaInputFile(*(FExrMemoryStream*)InputStream, NumThreads);
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("open"), FilePath, Exception);
+
+		// the stream must outlive the input file, so it is only freed on failure
+		delete (FExrMemoryStream*)InputStream;
+		InputStream = nullptr;
+	}
+}
+
+
+FTiledRgbaInputFile::~FTiledRgbaInputFile()
+{
+	delete (Imf::TiledRgbaInputFile*)InputFile;
+	delete (FExrMemoryStream*)InputStream;
+}
+
+
+FIntPoint FTiledRgbaInputFile::GetDataWindow(int32 Level) const
+{
+	Imath::Box2i Win = ((Imf::TiledRgbaInputFile*)InputFile)->dataWindowForLevel(Level, Level);
+
+	return FIntPoint(
+		Win.max.x - Win.min.x + 1,
+		Win.max.y - Win.min.y + 1
+	);
+}
+
+
+int32 FTiledRgbaInputFile::GetNumLevels() const
+{
+	Imf::TiledRgbaInputFile* TiledFile = (Imf::TiledRgbaInputFile*)InputFile;
+
+	switch (TiledFile->levelMode())
+	{
+	case Imf::MIPMAP_LEVELS:
+		return TiledFile->numLevels();
+
+	case Imf::RIPMAP_LEVELS:
+		return FMath::Min(TiledFile->numXLevels(), TiledFile->numYLevels());
+
+	default:
+		return 1;
+	}
+}
+
+
+bool FTiledRgbaInputFile::IsValid() const
+{
+	return (InputFile != nullptr);
+}
+
+
+bool FTiledRgbaInputFile::ReadLevel(int32 Level)
+{
+	SCOPE_CYCLE_COUNTER(STAT_OpenExrWrapper_ReadPixels);
+
+	Imf::TiledRgbaInputFile* TiledFile = (Imf::TiledRgbaInputFile*)InputFile;
+
+	try
+	{
+		TiledFile->readTiles(0, TiledFile->numXTiles(Level) - 1, 0, TiledFile->numYTiles(Level) - 1, Level, Level);
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("read tiles of"), FilePath, Exception);
+		return false;
+	}
+
+	return true;
+}
+
+
+bool FTiledRgbaInputFile::SetFrameBuffer(void* Buffer, const FIntPoint& BufferDim, int32 Level)
+{
+	Imath::Box2i Win = ((Imf::TiledRgbaInputFile*)InputFile)->dataWindowForLevel(Level, Level);
+
+	try
+	{
+		((Imf::TiledRgbaInputFile*)InputFile)->setFrameBuffer((Imf::Rgba*)Buffer - Win.min.x - Win.min.y * BufferDim.X, 1, BufferDim.X);
+	}
+	catch (const std::exception& Exception)
+	{
+		ExrLogException(TEXT("set frame buffer of"), FilePath, Exception);
+		return false;
+	}
+
+	return true;
 }
 
 
 IMPLEMENT_MODULE(FDefaultModuleImpl, OpenExrWrapper);
 
-#pragma warning(pop)
+#ifdef _MSC_VER
+	#pragma warning(pop)
+#endif
@@ -3,9 +3,114 @@
 #pragma once
 
 #include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "Containers/UnrealString.h"
 #include "Math/IntPoint.h"
 
-class FString;
+
+enum class EExrCompression : uint8
+{
+	None,
+	Rle,
+	Zips,
+	Zip,
+	Piz,
+	Pxr24,
+	B44,
+	B44a,
+	Dwaa,
+	Dwab,
+	Unknown
+};
+
+
+enum class EExrRgbaChannels : uint8
+{
+	Rgba,
+	Rgb,
+	Ya,
+	Y
+};
+
+
+class OPENEXRWRAPPER_API FExrMappedFile
+{
+public:
+
+	FExrMappedFile(const FString& FilePath);
+	FExrMappedFile(const FExrMappedFile& Container, int64 Offset, int64 Size, const FString& FilePath);
+	~FExrMappedFile();
+
+public:
+
+	const uint8* GetData() const { return Data; }
+	const FString& GetFilePath() const { return FilePath; }
+	int64 GetSize() const { return Size; }
+	bool IsValid() const { return (Data != nullptr); }
+
+private:
+
+	FExrMappedFile(const FExrMappedFile&) = delete;
+	FExrMappedFile& operator=(const FExrMappedFile&) = delete;
+
+	const uint8* Data;
+	FString FilePath;
+	bool OwnsMapping;
+	int64 Size;
+};
+
+
+class OPENEXRWRAPPER_API FChannelInputFile
+{
+public:
+
+	FChannelInputFile(const FString& FilePath, int32 NumThreads);
+	FChannelInputFile(const FString& FilePath, int32 Part, int32 NumThreads);
+	FChannelInputFile(const FExrMappedFile& MappedFile, int32 NumThreads);
+	FChannelInputFile(const FExrMappedFile& MappedFile, int32 Part, int32 NumThreads);
+	~FChannelInputFile();
+
+public:
+
+	FIntPoint GetDataWindow() const;
+	bool IsValid() const;
+	bool ReadPixels(int32 StartY, int32 EndY);
+	bool SetFrameBuffer(void* Buffer, const FIntPoint& Stride);
+	bool SetFrameBuffer(void* Buffer, const FIntPoint& Stride, const TArray<FString>& ChannelNames);
+
+private:
+
+	void Close();
+
+	FString FilePath;
+	void* InputFile;
+	void* InputPart;
+	void* InputStream;
+	void* MultiPartFile;
+};
+
+
+class OPENEXRWRAPPER_API FMultiPartInputFile
+{
+public:
+
+	FMultiPartInputFile(const FString& FilePath);
+	~FMultiPartInputFile();
+
+public:
+
+	void GetChannelNames(int32 Part, TArray<FString>& OutChannelNames) const;
+	FIntPoint GetDataWindow(int32 Part) const;
+	FIntPoint GetDataWindowOrigin(int32 Part) const;
+	int32 GetNumParts() const;
+	FString GetPartName(int32 Part) const;
+	bool HasHalfChannels(int32 Part) const;
+	bool IsValid() const;
+
+private:
+
+	void* InputFile;
+};
 
 
 class OPENEXRWRAPPER_API FRgbaInputFile
@@ -13,16 +118,77 @@ class OPENEXRWRAPPER_API FRgbaInputFile
 public:
 
 	FRgbaInputFile(const FString& FilePath);
+	FRgbaInputFile(const FString& FilePath, int32 NumThreads);
+	FRgbaInputFile(const FExrMappedFile& MappedFile, int32 NumThreads);
 	~FRgbaInputFile();
 
 public:
 
+	void GetChannelNames(TArray<FString>& OutChannelNames) const;
+	EExrCompression GetCompression() const;
 	FIntPoint GetDataWindow() const;
 	double GetFramesPerSecond(double DefaultValue) const;
-	void ReadPixels(int32 StartY, int32 EndY);
-	void SetFrameBuffer(void* Buffer, const FIntPoint& Stride);
+	int32 GetLinesPerBlock() const;
+	FIntPoint GetMipDataWindow(int32 Level) const;
+	int32 GetNumMipLevels() const;
+	bool HasHalfRgbaChannels() const;
+	bool IsValid() const;
+	bool ReadPixels(int32 StartY, int32 EndY);
+	bool SetFrameBuffer(void* Buffer, const FIntPoint& Stride);
+
+public:
+
+	static int32 GetGlobalThreadCount();
+	static void SetGlobalThreadCount(int32 ThreadCount);
+
+private:
+
+	FString FilePath;
+	void* InputFile;
+	void* InputStream;
+};
+
+
+class OPENEXRWRAPPER_API FRgbaOutputFile
+{
+public:
+
+	FRgbaOutputFile(const FString& FilePath, const FIntPoint& Dim, EExrCompression Compression, double FramesPerSecond, int32 NumThreads);
+	FRgbaOutputFile(const FString& FilePath, const FIntPoint& Dim, EExrCompression Compression, EExrRgbaChannels Channels, double FramesPerSecond, int32 NumThreads);
+	~FRgbaOutputFile();
+
+public:
+
+	bool IsValid() const;
+	void SetFrameBuffer(const void* Buffer, const FIntPoint& Stride);
+	bool WritePixels(int32 NumScanLines);
+
+private:
+
+	FString FilePath;
+	void* OutputFile;
+};
+
+
+class OPENEXRWRAPPER_API FTiledRgbaInputFile
+{
+public:
+
+	FTiledRgbaInputFile(const FString& FilePath, int32 NumThreads);
+	FTiledRgbaInputFile(const FExrMappedFile& MappedFile, int32 NumThreads);
+	~FTiledRgbaInputFile();
+
+public:
+
+	FIntPoint GetDataWindow(int32 Level) const;
+	int32 GetNumLevels() const;
+	bool IsValid() const;
+	bool ReadLevel(int32 Level);
+	bool SetFrameBuffer(void* Buffer, const FIntPoint& Stride, int32 Level);
 
 private:
 
+	FString FilePath;
 	void* InputFile;
+	void* InputStream;
 };